@@ -5,94 +5,499 @@
  *      Author: Christian Herold
  */
 #include <iostream>
+#include <sstream>
 #include <math.h>
 #include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
 #include "fft_computation.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template <typename T>
+int FftComputation<T>::threadCount = 1;
+
 //------------------------------------------------------------------------------
-FftComputation::FftComputation(unsigned long length)
+/*
+ * The local plans are created here, before any input has been distributed,
+ * because FFTW_MEASURE and above overwrite the arrays while planning.
+ * The backward plan maps the calc buffer back onto the initial buffer.
+ * A batch of vectors is stored interleaved, element i of vector v at
+ * i * batchCount + v, and transformed by one plan. The forward plan
+ * writes resultOffset bytes behind the start of calc buffer 1.
+ */
+template <typename T>
+FftComputation<T>::FftComputation(RdmaManager<T> * manager, unsigned long length,
+                                  unsigned int plannerFlags, bool withInverse,
+                                  unsigned long resultOffset)
 {
   this->vectorlength = length;
-  rdma = RdmaManager::getInstance();
-  twiddles = (fftw_complex*) fftw_malloc( sizeof(fftw_complex) * rdma->getBufferLength() );
-  assert(twiddles);
+  rdma = manager;
+  batchCount = rdma->getBatchCount();
+  twiddles = NULL;
+  twiddleScratch = NULL;
+  twiddleScratchLength = 0;
 
-  finalVector = (fftw_complex *) (((char *) rdma->getRdmaPointer())
-      + rdma->getCalcBufferOffset1());
+  butterfly = selectRadix2Kernel<T>();
 
-  srcVector   = (fftw_complex *) (((char *) rdma->getRdmaPointer())
+  finalVector = (complex_t *) (((char *) rdma->getRdmaPointer())
+      + rdma->getCalcBufferOffset1() + resultOffset);
+
+  srcVector   = (complex_t *) (((char *) rdma->getRdmaPointer())
       + rdma->getInitialOffset1());
+
+  fftwPlan = FftwTraits<T>::planManyDft(vectorlength, batchCount,
+        srcVector, batchCount, 1, finalVector, batchCount, 1,
+        FFTW_FORWARD, plannerFlags);
+
+  assert(fftwPlan);
+
+  inversePlan = NULL;
+  if (withInverse)
+  {
+    inversePlan = FftwTraits<T>::planManyDft(vectorlength, batchCount,
+          finalVector, batchCount, 1, srcVector, batchCount, 1,
+          FFTW_BACKWARD, plannerFlags);
+    assert(inversePlan);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+FftComputation<T>::~FftComputation()
+{
+  /* the cached twiddle tables are owned by the TwiddleCache */
+  twiddles = NULL;
+  if (twiddleScratch != NULL)
+    FftwTraits<T>::release(twiddleScratch);
+  FftwTraits<T>::destroyPlan(fftwPlan);
+  if (inversePlan != NULL)
+    FftwTraits<T>::destroyPlan(inversePlan);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftComputation<T>::calculateFftw()
+{
+  FftwTraits<T>::execute(fftwPlan);
 }
 
 //------------------------------------------------------------------------------
-FftComputation::~FftComputation()
+template <typename T>
+void FftComputation<T>::calculateInverseFftw()
 {
-  if (twiddles != NULL) {
-    fftw_free(twiddles);
-    twiddles = NULL;
+  assert(inversePlan);
+  FftwTraits<T>::execute(inversePlan);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Scales the local result of the backward transform in the initial buffer
+ */
+template <typename T>
+void FftComputation<T>::scaleResult(T factor)
+{
+  long length = vectorlength * batchCount;
+
+#pragma omp parallel for schedule(static) num_threads(threadCount) if(length >= (long) parallelThreshold)
+  for (long i = 0; i < length; i++)
+  {
+    srcVector[i] *= factor;
   }
 }
 
 //------------------------------------------------------------------------------
-void FftComputation::calculateFftw()
+template <typename T>
+void FftComputation<T>::printFftw()
 {
-  finalVector = (fftw_complex *) (((char *) rdma->getRdmaPointer())
+  gaspi_printf("Result of 1 d fftw\n");
+  finalVector = (complex_t *) (((char *) rdma->getRdmaPointer())
       + rdma->getCalcBufferOffset1());
+  for (unsigned long i = 0; i < vectorlength; i++)
+    gaspi_printf("%lf + %lf i\n", creal(finalVector[i]), cimag(finalVector[i]));
+}
 
-  srcVector   = (fftw_complex *) (((char *) rdma->getRdmaPointer())
-      + rdma->getInitialOffset1());
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long FftComputation<T>::getVectorLength()
+{
+  return vectorlength;
+}
 
-  fftwPlan = fftw_plan_dft_1d(vectorlength, srcVector, finalVector,
-        FFTW_FORWARD, FFTW_ESTIMATE);
+//------------------------------------------------------------------------------
+/*
+ * Wisdom is stored per node as <prefix>.<hostname>, the wisdom of the
+ * float and long double libraries as <prefix>.<precision>.<hostname>
+ */
+template <typename T>
+std::string FftComputation<T>::wisdomFileName(const std::string & prefix)
+{
+  std::string name = prefix;
+  if (FftwTraits<T>::name() != std::string("double"))
+  {
+    name = name + "." + FftwTraits<T>::name();
+  }
 
-  assert(fftwPlan);
+  char hostname[256];
+  if (gethostname(hostname, sizeof(hostname)) != 0)
+  {
+    return name;
+  }
+  hostname[sizeof(hostname) - 1] = '\0';
+  return name + "." + hostname;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+bool FftComputation<T>::importWisdom(const std::string & prefix)
+{
+  std::string file = wisdomFileName(prefix);
+  return FftwTraits<T>::importWisdom(file.c_str()) != 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * All ranks of a node share the file, so every rank writes a private
+ * temporary file and renames it into place atomically.
+ */
+template <typename T>
+bool FftComputation<T>::exportWisdom(const std::string & prefix)
+{
+  gaspi_rank_t rank;
+  gaspi_proc_rank( &rank );
 
-  fftw_execute(fftwPlan);
+  std::string file = wisdomFileName(prefix);
+  std::ostringstream tmp;
+  tmp << file << ".tmp." << rank;
 
-  fftw_destroy_plan(fftwPlan);
+  if (FftwTraits<T>::exportWisdom(tmp.str().c_str()) == 0)
+  {
+    std::cerr << "ERROR # exportWisdom # can't write " << tmp.str()
+        << std::endl;
+    return false;
+  }
+  if (rename(tmp.str().c_str(), file.c_str()) != 0)
+  {
+    std::cerr << "ERROR # exportWisdom # can't rename to " << file
+        << std::endl;
+    remove(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
 
+//------------------------------------------------------------------------------
+/*
+ * Threads per rank for the local FFTW plan, the butterfly and the twiddle
+ * generation. Has to be set before the first plan is created.
+ * Without OpenMP support the rank stays single threaded.
+ */
+template <typename T>
+void FftComputation<T>::setThreadCount(int threads)
+{
+#ifdef _OPENMP
+  static bool fftwThreadsReady = false;
+  if (!fftwThreadsReady)
+  {
+    fftwThreadsReady = FftwTraits<T>::initThreads() != 0;
+  }
+  threadCount = threads > 0 ? threads : 1;
+  if (fftwThreadsReady)
+  {
+    FftwTraits<T>::planWithNthreads(threadCount);
+  }
+  omp_set_num_threads(threadCount);
+#else
+  if (threads > 1)
+  {
+    std::cerr << "WARNING # setThreadCount # built without OpenMP, "
+        << "running single threaded" << std::endl;
+  }
+  threadCount = 1;
+#endif
 }
 
 //------------------------------------------------------------------------------
-void FftComputation::printFftw()
+template <typename T>
+int FftComputation<T>::getThreadCount()
 {
-  gaspi_printf("Result of 1 d fftw\n");
-  finalVector = (fftw_complex *) (((char *) rdma->getRdmaPointer())
+  return threadCount;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftComputation<T>::calculateTwiddles(unsigned long kmin,
+                                          unsigned long mergelength,
+                                          unsigned long length)
+{
+  if (TwiddleCache<T>::getInstance()->getMode() == twiddles_cached)
+  {
+    twiddles = TwiddleCache<T>::getInstance()->getTable(kmin, mergelength, length);
+    return;
+  }
+
+  if (twiddleScratchLength < length)
+  {
+    if (twiddleScratch != NULL)
+      FftwTraits<T>::release(twiddleScratch);
+    twiddleScratch = (complex_t *) FftwTraits<T>::allocate(sizeof(complex_t) * length);
+    assert(twiddleScratch);
+    twiddleScratchLength = length;
+  }
+  TwiddleCache<T>::fillTable(twiddleScratch, kmin, mergelength, length);
+  twiddles = twiddleScratch;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Turns Z, the transform of the packed real signal z[t] = x[2t] + I x[2t+1]
+ * of length M = N / 2, into the first M outputs of the real transform
+ *   X[k] = (Z[k] + conj(Z[M-k])) / 2
+ *        - I / 2 * exp(-2 pi I k / N) * (Z[k] - conj(Z[M-k]))
+ * Block j of the calc buffer holds Z[k], k = j * M / radix
+ * + position * blocklength + t. mirror is the calc buffer of the rank at
+ * position groupsize - 1 - position, it holds Z[M-k] for t > 0 in reverse
+ * order. edge[j] is Z[M-k] for t = 0.
+ * The inverse turns X back into 2 Z,
+ *   2 Z[k] = (X[k] + conj(X[M-k])) + I * exp(2 pi I k / N) * (X[k] - conj(X[M-k]))
+ * with the Nyquist value X[M] in place of X[0] as mirror of k = 0.
+ * Every vector of a batch is split on its own.
+ */
+template <typename T>
+void FftComputation<T>::realSplit(unsigned int radix,
+                                  unsigned long blocklength,
+                                  unsigned long groupsize,
+                                  unsigned long position,
+                                  const complex_t * mirror,
+                                  const complex_t * edge,
+                                  bool inverse)
+{
+  complex_t * z = (complex_t *) (((char *) rdma->getRdmaPointer())
       + rdma->getCalcBufferOffset1());
-  for (unsigned long i = 0; i < vectorlength; i++)
-    gaspi_printf("%lf + %lf i\n", creal(finalVector[i]), cimag(finalVector[i]));
+  unsigned long M = radix * groupsize * blocklength;
+  const T half = inverse ? 1.0 : 0.5;
+
+  for (unsigned int j = 0; j < radix; j++)
+  {
+    unsigned long kmin = j * groupsize * blocklength + position * blocklength;
+    const complex_t * w = TwiddleCache<T>::getInstance()->getTable(kmin, 2 * M,
+                                                                   blocklength);
+    complex_t * zj = z + j * blocklength * batchCount;
+    const complex_t * mj = mirror + (radix - 1 - j) * blocklength * batchCount;
+    long length = blocklength;
+    long batch  = batchCount;
+
+#pragma omp parallel for schedule(static) num_threads(threadCount) if(length * batch >= (long) parallelThreshold)
+    for (long t = 0; t < length; t++)
+    {
+      const complex_t * zm = t == 0 ? edge + j * batch
+                                    : mj + (length - t) * batch;
+      complex_t * zt = zj + t * batch;
+
+      for (long v = 0; v < batch; v++)
+      {
+        complex_t zc   = FftwTraits<T>::conj(zm[v]);
+        complex_t even = (zt[v] + zc) * half;
+
+        if (inverse)
+          zt[v] = even + I * FftwTraits<T>::conj(w[t]) * (zt[v] - zc);
+        else
+          zt[v] = even + w[t] * ((zt[v] - zc) * (-half * I));
+      }
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
-unsigned long FftComputation::getVectorLength()
+/*
+ * Combines the radix inputs of one merge stage. The result is written as
+ * radix consecutive blocks of blocklength elements into output, block v
+ * at element v * blocklength. Only the elements begin ...
+ * begin + count - 1 of every block are merged, so a stage can be merged
+ * chunk by chunk.
+ */
+template <typename T>
+void FftComputation<T>::radixMerge(unsigned int radix,
+                                   const complex_t * const * inputs,
+                                   complex_t * output,
+                                   unsigned long blocklength,
+                                   unsigned long begin,
+                                   unsigned long count)
 {
-  return vectorlength;
+  complex_t * outputs[maxKernelRadix];
+
+  for (unsigned int v = 0; v < radix; v++)
+  {
+    outputs[v] = output + v * blocklength * batchCount;
+  }
+  mergeBlocks(false, radix, inputs, outputs, begin, count);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Reverses radixMerge (without the factor 1 / radix): reads the radix
+ * blocks of the calc buffer and writes the inputs of the forward merge.
+ */
+template <typename T>
+void FftComputation<T>::inverseMerge(unsigned int radix,
+                                     complex_t * const * outputs,
+                                     unsigned long blocklength)
+{
+  complex_t * input = (complex_t *) (((char *) rdma->getRdmaPointer())
+      + rdma->getCalcBufferOffset1());
+  const complex_t * inputs[maxKernelRadix];
+
+  for (unsigned int v = 0; v < radix; v++)
+  {
+    inputs[v] = input + v * blocklength * batchCount;
+  }
+  mergeBlocks(true, radix, inputs, outputs, 0, blocklength);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftComputation<T>::mergeBlocks(bool inverse,
+                                    unsigned int radix,
+                                    const complex_t * const * inputs,
+                                    complex_t * const * outputs,
+                                    unsigned long begin,
+                                    unsigned long count)
+{
+  /* the threads split the values of all vectors of the batch */
+  unsigned long values = count * batchCount;
+  begin *= batchCount;
+
+  if ((threadCount < 2) || (values < parallelThreshold))
+  {
+    mergeSpan(inverse, radix, inputs, outputs, begin, values);
+    return;
+  }
+
+  /*
+   * one contiguous span per thread, kept a multiple of the vector width,
+   * rounded up so the spans cover values even if it is smaller than the
+   * thread count or not divisible by it
+   */
+  long chunks = threadCount;
+  unsigned long chunklength = (((values + chunks - 1) / chunks) + 7) & ~7UL;
+
+#pragma omp parallel for schedule(static) num_threads(threadCount)
+  for (long c = 0; c < chunks; c++)
+  {
+    unsigned long first = c * chunklength;
+    if (first < values)
+    {
+      unsigned long length = values - first < chunklength ?
+          values - first : chunklength;
+      mergeSpan(inverse, radix, inputs, outputs, begin + first, length);
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
-void FftComputation::calculateTwiddles(unsigned long kmin,
-                                       unsigned long mergelength)
+/*
+ * begin and count index values, value i * batchCount + v is element i of
+ * vector v
+ */
+template <typename T>
+void FftComputation<T>::mergeSpan(bool inverse,
+                                  unsigned int radix,
+                                  const complex_t * const * inputs,
+                                  complex_t * const * outputs,
+                                  unsigned long begin,
+                                  unsigned long count)
 {
-  for (unsigned int i = 0; i < rdma->getBufferLength(); i++, kmin++) {
-    twiddles[i] = cexp(I * M_PI * 2 * kmin * -1 / mergelength);
+  if (batchCount > 1)
+  {
+    mergeBatchSpan(inverse, radix, inputs, outputs, begin, count);
+    return;
   }
+  mergeValues(inverse, radix, inputs, outputs, twiddles + begin, begin, count);
 }
 
 //------------------------------------------------------------------------------
-void FftComputation::radix2FFT(unsigned int level)
+/*
+ * All vectors of a batch share the twiddle of an element, the kernels get
+ * it repeated batchCount times from a small per thread buffer.
+ */
+template <typename T>
+void FftComputation<T>::mergeBatchSpan(bool inverse,
+                                       unsigned int radix,
+                                       const complex_t * const * inputs,
+                                       complex_t * const * outputs,
+                                       unsigned long begin,
+                                       unsigned long count)
 {
-  unsigned long bufferlength = rdma->getBufferLength();
-  fftw_complex minuend = 0.0, subrathend = 0.0;
+  complex_t repeated[batchTwiddleLength];
+  unsigned long first = begin;
+  unsigned long last  = begin + count;
 
-  for (unsigned long i = 0; i < bufferlength; i++)
+  for (unsigned long value = first; value < last; value += batchTwiddleLength)
   {
+    unsigned long length = last - value < batchTwiddleLength ?
+        last - value : batchTwiddleLength;
 
-    minuend = rdma->getVectorElement(i, level);
+    for (unsigned long i = 0; i < length; i++)
+    {
+      repeated[i] = twiddles[(value + i) / batchCount];
+    }
+    mergeValues(inverse, radix, inputs, outputs, repeated, value, length);
+  }
+}
 
-    subrathend = rdma->getVectorElement(i + bufferlength, level);
+//------------------------------------------------------------------------------
+template <typename T>
+void FftComputation<T>::mergeValues(bool inverse,
+                                    unsigned int radix,
+                                    const complex_t * const * inputs,
+                                    complex_t * const * outputs,
+                                    const complex_t * tw,
+                                    unsigned long begin,
+                                    unsigned long count)
+{
+  /* the kernels see the interleaved scalars of the complex values */
+  const T * in[maxKernelRadix];
+  T *       out[maxKernelRadix];
+  const T * w = (const T *) tw;
 
-    (*(*rdma)[i]) = minuend + (subrathend * twiddles[i]);
+  for (unsigned int m = 0; m < radix; m++)
+  {
+    in[m]  = (const T *) (inputs[m] + begin);
+    out[m] = (T *) (outputs[m] + begin);
+  }
 
-    (*(*rdma)[i + bufferlength]) = minuend - (subrathend * twiddles[i]);
+  if (inverse)
+  {
+    if (radix == 2)
+      inverseRadix2Kernel<T>(in, w, out, count);
+    else if (radix == 4)
+      inverseRadix4Kernel<T>(in, w, out, count);
+    else if (radix == 8)
+      inverseRadix8Kernel<T>(in, w, out, count);
+    else
+      inverseRadixPKernel<T>(radix, in, w, out, count);
+  }
+  else if (radix == 2)
+  {
+    butterfly(in[0], in[1], w, out[0], out[1], count);
+  }
+  else if (radix == 4)
+  {
+    radix4Kernel<T>(in, w, out, count);
+  }
+  else if (radix == 8)
+  {
+    radix8Kernel<T>(in, w, out, count);
+  }
+  else
+  {
+    radixPKernel<T>(radix, in, w, out, count);
   }
 }
+
+//------------------------------------------------------------------------------
+template class FftComputation<float>;
+template class FftComputation<double>;
+template class FftComputation<long double>;
@@ -6,34 +6,117 @@
  */
 #ifndef FFT_COMPUTATION_HPP
 #define FFT_COMPUTATION_HPP
-#include <complex.h>
-#include <fftw3.h>
+#include <string>
+#include "fftw_traits.hpp"
 #include "rdma_manager.hpp"
+#include "fft_kernels.hpp"
+#include "twiddle_cache.hpp"
 
+/*
+ * Local part of a transform with complex values of precision T
+ */
+template <typename T>
 class FftComputation {
 
 public:
-  explicit FftComputation(unsigned long length);
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  FftComputation(RdmaManager<T> * manager, unsigned long length,
+                 unsigned int plannerFlags, bool withInverse = false,
+                 unsigned long resultOffset = 0);
   ~FftComputation();
 
-  void radix2FFT(unsigned int level);
+  void radixMerge(unsigned int radix,
+                  const complex_t * const * inputs,
+                  complex_t * output,
+                  unsigned long blocklength,
+                  unsigned long begin,
+                  unsigned long count);
+
+  void inverseMerge(unsigned int radix,
+                    complex_t * const * outputs,
+                    unsigned long blocklength);
 
-  void calculateTwiddles(unsigned long kmin, unsigned long mergelength);
+  void calculateTwiddles(unsigned long kmin, unsigned long mergelength,
+                         unsigned long length);
+
+  void realSplit(unsigned int radix,
+                 unsigned long blocklength,
+                 unsigned long groupsize,
+                 unsigned long position,
+                 const complex_t * mirror,
+                 const complex_t * edge,
+                 bool inverse = false);
 
   void calculateFftw();
 
+  void calculateInverseFftw();
+
+  void scaleResult(T factor);
+
   void printFftw();
 
   unsigned long getVectorLength();
 
+  static std::string wisdomFileName(const std::string & prefix);
+  static bool importWisdom(const std::string & prefix);
+  static bool exportWisdom(const std::string & prefix);
+
+  static void setThreadCount(int threads);
+  static int  getThreadCount();
+
 private:
-  fftw_complex * srcVector;
-  fftw_complex * finalVector;
+  complex_t * srcVector;
+  complex_t * finalVector;
   unsigned long vectorlength;
   unsigned long totalLength;
-  fftw_plan fftwPlan;
-  RdmaManager * rdma;
-  fftw_complex * twiddles;
+  unsigned int batchCount;
+  typename FftwTraits<T>::plan_t fftwPlan;
+  typename FftwTraits<T>::plan_t inversePlan;
+  RdmaManager<T> * rdma;
+  const complex_t * twiddles;
+  /*
+   * On-the-fly twiddles of this transform, the table stays valid while
+   * the stage is merged chunk by chunk, even if other transforms of the
+   * process are in flight
+   */
+  complex_t * twiddleScratch;
+  unsigned long twiddleScratchLength;
+  typename Radix2Kernel<T>::type butterfly;
+  static int threadCount;
+  /* below this many elements per stage the butterfly stays serial */
+  static const unsigned long parallelThreshold = 16384;
+  /* repeated twiddles handed to the kernels per call in batch mode */
+  static const unsigned long batchTwiddleLength = 512;
+
+  void mergeBlocks(bool inverse,
+                   unsigned int radix,
+                   const complex_t * const * inputs,
+                   complex_t * const * outputs,
+                   unsigned long begin,
+                   unsigned long count);
+
+  void mergeSpan(bool inverse,
+                 unsigned int radix,
+                 const complex_t * const * inputs,
+                 complex_t * const * outputs,
+                 unsigned long begin,
+                 unsigned long count);
+
+  void mergeBatchSpan(bool inverse,
+                      unsigned int radix,
+                      const complex_t * const * inputs,
+                      complex_t * const * outputs,
+                      unsigned long begin,
+                      unsigned long count);
+
+  void mergeValues(bool inverse,
+                   unsigned int radix,
+                   const complex_t * const * inputs,
+                   complex_t * const * outputs,
+                   const complex_t * tw,
+                   unsigned long begin,
+                   unsigned long count);
 
 };
 #endif
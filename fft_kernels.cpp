@@ -0,0 +1,623 @@
+/*
+ * fft_kernels.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include "fft_kernels.hpp"
+
+#include <stddef.h>
+#include <math.h>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FFT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+template <typename T>
+static void radix2Scalar( const T *     e,
+                          const T *     o,
+                          const T *     w,
+                          T *           l,
+                          T *           h,
+                          unsigned long count )
+{
+  for (unsigned long i = 0; i < 2 * count; i += 2)
+  {
+    T tr = o[i] * w[i] - o[i + 1] * w[i + 1];
+    T ti = o[i] * w[i + 1] + o[i + 1] * w[i];
+    T er = e[i];
+    T ei = e[i + 1];
+
+    l[i]     = er + tr;
+    l[i + 1] = ei + ti;
+    h[i]     = er - tr;
+    h[i + 1] = ei - ti;
+  }
+}
+
+#ifdef FFT_KERNELS_X86
+//------------------------------------------------------------------------------
+__attribute__((target("avx2,fma")))
+static void radix2Avx2( const double * e,
+                        const double * o,
+                        const double * w,
+                        double *       l,
+                        double *       h,
+                        unsigned long  count )
+{
+  unsigned long i = 0;
+  unsigned long vecEnd = 2 * (count & ~1UL);
+
+  /* two complex values per register: [re0 im0 re1 im1] */
+  for (; i < vecEnd; i += 4)
+  {
+    __m256d ov = _mm256_loadu_pd(o + i);
+    __m256d wv = _mm256_loadu_pd(w + i);
+    __m256d ev = _mm256_loadu_pd(e + i);
+
+    __m256d wre = _mm256_movedup_pd(wv);
+    __m256d wim = _mm256_permute_pd(wv, 0xF);
+    __m256d osw = _mm256_permute_pd(ov, 0x5);
+    __m256d t   = _mm256_fmaddsub_pd(ov, wre, _mm256_mul_pd(osw, wim));
+
+    _mm256_storeu_pd(l + i, _mm256_add_pd(ev, t));
+    _mm256_storeu_pd(h + i, _mm256_sub_pd(ev, t));
+  }
+  if (i < 2 * count)
+  {
+    radix2Scalar(e + i, o + i, w + i, l + i, h + i, count - i / 2);
+  }
+}
+
+//------------------------------------------------------------------------------
+__attribute__((target("avx512f")))
+static void radix2Avx512( const double * e,
+                          const double * o,
+                          const double * w,
+                          double *       l,
+                          double *       h,
+                          unsigned long  count )
+{
+  unsigned long i = 0;
+  unsigned long vecEnd = 2 * (count & ~3UL);
+  const __mmask8 all = 0xFF;
+
+  /* four complex values per register */
+  for (; i < vecEnd; i += 8)
+  {
+    __m512d ov = _mm512_loadu_pd(o + i);
+    __m512d wv = _mm512_loadu_pd(w + i);
+    __m512d ev = _mm512_loadu_pd(e + i);
+
+    /* the zero-masked forms, the plain ones start from an undefined
+       vector which -O2 reports as maybe uninitialized */
+    __m512d wre = _mm512_maskz_movedup_pd(all, wv);
+    __m512d wim = _mm512_maskz_permute_pd(all, wv, 0xFF);
+    __m512d osw = _mm512_maskz_permute_pd(all, ov, 0x55);
+    __m512d t   = _mm512_fmaddsub_pd(ov, wre, _mm512_mul_pd(osw, wim));
+
+    _mm512_storeu_pd(l + i, _mm512_add_pd(ev, t));
+    _mm512_storeu_pd(h + i, _mm512_sub_pd(ev, t));
+  }
+  if (i < 2 * count)
+  {
+    radix2Scalar(e + i, o + i, w + i, l + i, h + i, count - i / 2);
+  }
+}
+
+//------------------------------------------------------------------------------
+__attribute__((target("avx2,fma")))
+static void radix2Avx2( const float * e,
+                        const float * o,
+                        const float * w,
+                        float *       l,
+                        float *       h,
+                        unsigned long count )
+{
+  unsigned long i = 0;
+  unsigned long vecEnd = 2 * (count & ~3UL);
+
+  /* four complex values per register: [re0 im0 re1 im1 ...] */
+  for (; i < vecEnd; i += 8)
+  {
+    __m256 ov = _mm256_loadu_ps(o + i);
+    __m256 wv = _mm256_loadu_ps(w + i);
+    __m256 ev = _mm256_loadu_ps(e + i);
+
+    __m256 wre = _mm256_moveldup_ps(wv);
+    __m256 wim = _mm256_movehdup_ps(wv);
+    __m256 osw = _mm256_permute_ps(ov, 0xB1);
+    __m256 t   = _mm256_fmaddsub_ps(ov, wre, _mm256_mul_ps(osw, wim));
+
+    _mm256_storeu_ps(l + i, _mm256_add_ps(ev, t));
+    _mm256_storeu_ps(h + i, _mm256_sub_ps(ev, t));
+  }
+  if (i < 2 * count)
+  {
+    radix2Scalar(e + i, o + i, w + i, l + i, h + i, count - i / 2);
+  }
+}
+
+//------------------------------------------------------------------------------
+__attribute__((target("avx512f")))
+static void radix2Avx512( const float * e,
+                          const float * o,
+                          const float * w,
+                          float *       l,
+                          float *       h,
+                          unsigned long count )
+{
+  unsigned long i = 0;
+  unsigned long vecEnd = 2 * (count & ~7UL);
+  const __mmask16 all = 0xFFFF;
+
+  /* eight complex values per register */
+  for (; i < vecEnd; i += 16)
+  {
+    __m512 ov = _mm512_loadu_ps(o + i);
+    __m512 wv = _mm512_loadu_ps(w + i);
+    __m512 ev = _mm512_loadu_ps(e + i);
+
+    __m512 wre = _mm512_maskz_moveldup_ps(all, wv);
+    __m512 wim = _mm512_maskz_movehdup_ps(all, wv);
+    __m512 osw = _mm512_maskz_permute_ps(all, ov, 0xB1);
+    __m512 t   = _mm512_fmaddsub_ps(ov, wre, _mm512_mul_ps(osw, wim));
+
+    _mm512_storeu_ps(l + i, _mm512_add_ps(ev, t));
+    _mm512_storeu_ps(h + i, _mm512_sub_ps(ev, t));
+  }
+  if (i < 2 * count)
+  {
+    radix2Scalar(e + i, o + i, w + i, l + i, h + i, count - i / 2);
+  }
+}
+#endif
+
+//------------------------------------------------------------------------------
+template <typename T>
+void radix4Kernel( const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count )
+{
+  const T * x0 = inputs[0];
+  const T * x1 = inputs[1];
+  const T * x2 = inputs[2];
+  const T * x3 = inputs[3];
+  const T * w  = twiddles;
+  T *       y0 = outputs[0];
+  T *       y1 = outputs[1];
+  T *       y2 = outputs[2];
+  T *       y3 = outputs[3];
+
+  for (unsigned long i = 0; i < 2 * count; i += 2)
+  {
+    T w1r = w[i];
+    T w1i = w[i + 1];
+    T w2r = w1r * w1r - w1i * w1i;
+    T w2i = 2 * w1r * w1i;
+    T w3r = w2r * w1r - w2i * w1i;
+    T w3i = w2r * w1i + w2i * w1r;
+
+    T a0r = x0[i];
+    T a0i = x0[i + 1];
+    T a1r = x1[i] * w1r - x1[i + 1] * w1i;
+    T a1i = x1[i] * w1i + x1[i + 1] * w1r;
+    T a2r = x2[i] * w2r - x2[i + 1] * w2i;
+    T a2i = x2[i] * w2i + x2[i + 1] * w2r;
+    T a3r = x3[i] * w3r - x3[i + 1] * w3i;
+    T a3i = x3[i] * w3i + x3[i + 1] * w3r;
+
+    T s02r = a0r + a2r, s02i = a0i + a2i;
+    T d02r = a0r - a2r, d02i = a0i - a2i;
+    T s13r = a1r + a3r, s13i = a1i + a3i;
+    T d13r = a1r - a3r, d13i = a1i - a3i;
+
+    /* exp(-2 pi I / 4) = -I */
+    y0[i]     = s02r + s13r;
+    y0[i + 1] = s02i + s13i;
+    y1[i]     = d02r + d13i;
+    y1[i + 1] = d02i - d13r;
+    y2[i]     = s02r - s13r;
+    y2[i + 1] = s02i - s13i;
+    y3[i]     = d02r - d13i;
+    y3[i + 1] = d02i + d13r;
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Length-8 DFT in place, split into two length-4 DFTs of the even and
+ * odd values, dir = -1 for the roots of the forward merge, +1 for the
+ * inverse ones
+ */
+template <typename T>
+static inline void dft8( T * re, T * im, T dir )
+{
+  const T c = (T) 0.70710678118654752440084436210484903928L;
+  /* W_8^(-dir * v), v = 0 ... 3 */
+  const T rootRe[4] = { 1, c, 0, -c };
+  const T rootIm[4] = { 0, dir * c, dir, dir * c };
+  T eRe[4], eIm[4], oRe[4], oIm[4];
+
+  for (unsigned int h = 0; h < 2; h++)
+  {
+    T * yRe = h == 0 ? eRe : oRe;
+    T * yIm = h == 0 ? eIm : oIm;
+
+    T s02r = re[h] + re[h + 4], s02i = im[h] + im[h + 4];
+    T d02r = re[h] - re[h + 4], d02i = im[h] - im[h + 4];
+    T s13r = re[h + 2] + re[h + 6], s13i = im[h + 2] + im[h + 6];
+    T d13r = re[h + 2] - re[h + 6], d13i = im[h + 2] - im[h + 6];
+
+    yRe[0] = s02r + s13r;
+    yIm[0] = s02i + s13i;
+    yRe[1] = d02r - dir * d13i;
+    yIm[1] = d02i + dir * d13r;
+    yRe[2] = s02r - s13r;
+    yIm[2] = s02i - s13i;
+    yRe[3] = d02r + dir * d13i;
+    yIm[3] = d02i - dir * d13r;
+  }
+
+  for (unsigned int v = 0; v < 4; v++)
+  {
+    T tr = oRe[v] * rootRe[v] - oIm[v] * rootIm[v];
+    T ti = oRe[v] * rootIm[v] + oIm[v] * rootRe[v];
+
+    re[v]     = eRe[v] + tr;
+    im[v]     = eIm[v] + ti;
+    re[v + 4] = eRe[v] - tr;
+    im[v + 4] = eIm[v] - ti;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void radix8Kernel( const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count )
+{
+  T aRe[8];
+  T aIm[8];
+
+  for (unsigned long u = 0; u < count; u++)
+  {
+    T wr = twiddles[2 * u];
+    T wi = twiddles[2 * u + 1];
+    T tr = wr;
+    T ti = wi;
+
+    aRe[0] = inputs[0][2 * u];
+    aIm[0] = inputs[0][2 * u + 1];
+    for (unsigned int m = 1; m < 8; m++)
+    {
+      T xr = inputs[m][2 * u];
+      T xi = inputs[m][2 * u + 1];
+      aRe[m] = xr * tr - xi * ti;
+      aIm[m] = xr * ti + xi * tr;
+
+      T nr = tr * wr - ti * wi;
+      ti = tr * wi + ti * wr;
+      tr = nr;
+    }
+
+    dft8<T>(aRe, aIm, -1);
+
+    for (unsigned int v = 0; v < 8; v++)
+    {
+      outputs[v][2 * u]     = aRe[v];
+      outputs[v][2 * u + 1] = aIm[v];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void radixPKernel( unsigned int      radix,
+                   const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count )
+{
+  T rootRe[maxKernelRadix];
+  T rootIm[maxKernelRadix];
+  T aRe[maxKernelRadix];
+  T aIm[maxKernelRadix];
+
+  for (unsigned int k = 0; k < radix; k++)
+  {
+    rootRe[k] = (T) std::cos(-2.0L * M_PIl * k / radix);
+    rootIm[k] = (T) std::sin(-2.0L * M_PIl * k / radix);
+  }
+
+  for (unsigned long u = 0; u < count; u++)
+  {
+    T wr = twiddles[2 * u];
+    T wi = twiddles[2 * u + 1];
+    T tr = 1;
+    T ti = 0;
+
+    for (unsigned int m = 0; m < radix; m++)
+    {
+      T xr = inputs[m][2 * u];
+      T xi = inputs[m][2 * u + 1];
+      aRe[m] = xr * tr - xi * ti;
+      aIm[m] = xr * ti + xi * tr;
+
+      T nr = tr * wr - ti * wi;
+      ti = tr * wi + ti * wr;
+      tr = nr;
+    }
+
+    for (unsigned int v = 0; v < radix; v++)
+    {
+      T accr = 0;
+      T acci = 0;
+      for (unsigned int m = 0; m < radix; m++)
+      {
+        unsigned int k = (m * v) % radix;
+        accr += aRe[m] * rootRe[k] - aIm[m] * rootIm[k];
+        acci += aRe[m] * rootIm[k] + aIm[m] * rootRe[k];
+      }
+      outputs[v][2 * u]     = accr;
+      outputs[v][2 * u + 1] = acci;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void inverseRadix2Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count )
+{
+  const T * z0 = inputs[0];
+  const T * z1 = inputs[1];
+  const T * w  = twiddles;
+  T *       x0 = outputs[0];
+  T *       x1 = outputs[1];
+
+  for (unsigned long i = 0; i < 2 * count; i += 2)
+  {
+    T dr = z0[i] - z1[i];
+    T di = z0[i + 1] - z1[i + 1];
+
+    x0[i]     = z0[i] + z1[i];
+    x0[i + 1] = z0[i + 1] + z1[i + 1];
+    /* times conj(w) */
+    x1[i]     = dr * w[i] + di * w[i + 1];
+    x1[i + 1] = di * w[i] - dr * w[i + 1];
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void inverseRadix4Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count )
+{
+  const T * z0 = inputs[0];
+  const T * z1 = inputs[1];
+  const T * z2 = inputs[2];
+  const T * z3 = inputs[3];
+  const T * w  = twiddles;
+  T *       x0 = outputs[0];
+  T *       x1 = outputs[1];
+  T *       x2 = outputs[2];
+  T *       x3 = outputs[3];
+
+  for (unsigned long i = 0; i < 2 * count; i += 2)
+  {
+    T s02r = z0[i] + z2[i], s02i = z0[i + 1] + z2[i + 1];
+    T d02r = z0[i] - z2[i], d02i = z0[i + 1] - z2[i + 1];
+    T s13r = z1[i] + z3[i], s13i = z1[i + 1] + z3[i + 1];
+    T d13r = z1[i] - z3[i], d13i = z1[i + 1] - z3[i + 1];
+
+    /* exp(2 pi I / 4) = I */
+    T a1r = d02r - d13i, a1i = d02i + d13r;
+    T a2r = s02r - s13r, a2i = s02i - s13i;
+    T a3r = d02r + d13i, a3i = d02i - d13r;
+
+    /* conjugated twiddles */
+    T w1r = w[i];
+    T w1i = -w[i + 1];
+    T w2r = w1r * w1r - w1i * w1i;
+    T w2i = 2 * w1r * w1i;
+    T w3r = w2r * w1r - w2i * w1i;
+    T w3i = w2r * w1i + w2i * w1r;
+
+    x0[i]     = s02r + s13r;
+    x0[i + 1] = s02i + s13i;
+    x1[i]     = a1r * w1r - a1i * w1i;
+    x1[i + 1] = a1r * w1i + a1i * w1r;
+    x2[i]     = a2r * w2r - a2i * w2i;
+    x2[i + 1] = a2r * w2i + a2i * w2r;
+    x3[i]     = a3r * w3r - a3i * w3i;
+    x3[i + 1] = a3r * w3i + a3i * w3r;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void inverseRadix8Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count )
+{
+  T zRe[8];
+  T zIm[8];
+
+  for (unsigned long u = 0; u < count; u++)
+  {
+    /* conjugated twiddles */
+    T wr = twiddles[2 * u];
+    T wi = -twiddles[2 * u + 1];
+    T tr = wr;
+    T ti = wi;
+
+    for (unsigned int v = 0; v < 8; v++)
+    {
+      zRe[v] = inputs[v][2 * u];
+      zIm[v] = inputs[v][2 * u + 1];
+    }
+
+    dft8<T>(zRe, zIm, 1);
+
+    outputs[0][2 * u]     = zRe[0];
+    outputs[0][2 * u + 1] = zIm[0];
+    for (unsigned int m = 1; m < 8; m++)
+    {
+      outputs[m][2 * u]     = zRe[m] * tr - zIm[m] * ti;
+      outputs[m][2 * u + 1] = zRe[m] * ti + zIm[m] * tr;
+
+      T nr = tr * wr - ti * wi;
+      ti = tr * wi + ti * wr;
+      tr = nr;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void inverseRadixPKernel( unsigned int      radix,
+                          const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count )
+{
+  T rootRe[maxKernelRadix];
+  T rootIm[maxKernelRadix];
+  T zRe[maxKernelRadix];
+  T zIm[maxKernelRadix];
+
+  for (unsigned int k = 0; k < radix; k++)
+  {
+    rootRe[k] = (T) std::cos(2.0L * M_PIl * k / radix);
+    rootIm[k] = (T) std::sin(2.0L * M_PIl * k / radix);
+  }
+
+  for (unsigned long u = 0; u < count; u++)
+  {
+    T wr = twiddles[2 * u];
+    T wi = -twiddles[2 * u + 1];
+    T tr = 1;
+    T ti = 0;
+
+    for (unsigned int v = 0; v < radix; v++)
+    {
+      zRe[v] = inputs[v][2 * u];
+      zIm[v] = inputs[v][2 * u + 1];
+    }
+
+    for (unsigned int m = 0; m < radix; m++)
+    {
+      T accr = 0;
+      T acci = 0;
+      for (unsigned int v = 0; v < radix; v++)
+      {
+        unsigned int k = (m * v) % radix;
+        accr += zRe[v] * rootRe[k] - zIm[v] * rootIm[k];
+        acci += zRe[v] * rootIm[k] + zIm[v] * rootRe[k];
+      }
+      outputs[m][2 * u]     = accr * tr - acci * ti;
+      outputs[m][2 * u + 1] = accr * ti + acci * tr;
+
+      T nr = tr * wr - ti * wi;
+      ti = tr * wi + ti * wr;
+      tr = nr;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+struct KernelChoice
+{
+  typename Radix2Kernel<T>::type kernel;
+  const char *                   name;
+};
+
+/* overloads pick the vector kernels available for a scalar type */
+template <typename T>
+static KernelChoice<T> pickKernel(T)
+{
+  KernelChoice<T> choice;
+  choice.kernel = radix2Scalar<T>;
+  choice.name   = "scalar";
+  return choice;
+}
+
+#ifdef FFT_KERNELS_X86
+template <typename T>
+static KernelChoice<T> pickVectorKernel()
+{
+  KernelChoice<T> choice = pickKernel<T>(T());
+
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    choice.kernel = radix2Avx512;
+    choice.name   = "avx512";
+  }
+  else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  {
+    choice.kernel = radix2Avx2;
+    choice.name   = "avx2";
+  }
+  return choice;
+}
+
+static KernelChoice<float>  pickKernel(float)  { return pickVectorKernel<float>(); }
+static KernelChoice<double> pickKernel(double) { return pickVectorKernel<double>(); }
+#endif
+
+template <typename T>
+static const KernelChoice<T> & chosenKernel()
+{
+  static const KernelChoice<T> choice = pickKernel(T());
+  return choice;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+typename Radix2Kernel<T>::type selectRadix2Kernel()
+{
+  return chosenKernel<T>().kernel;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+const char * radix2KernelName()
+{
+  return chosenKernel<T>().name;
+}
+
+//------------------------------------------------------------------------------
+#define INSTANTIATE_KERNELS(T)                                                 \
+  template Radix2Kernel<T>::type selectRadix2Kernel<T>();                      \
+  template const char * radix2KernelName<T>();                                 \
+  template void radix4Kernel<T>(const T * const *, const T *, T * const *,     \
+                                unsigned long);                                \
+  template void radix8Kernel<T>(const T * const *, const T *, T * const *,     \
+                                unsigned long);                                \
+  template void radixPKernel<T>(unsigned int, const T * const *, const T *,    \
+                                T * const *, unsigned long);                   \
+  template void inverseRadix2Kernel<T>(const T * const *, const T *,           \
+                                       T * const *, unsigned long);            \
+  template void inverseRadix4Kernel<T>(const T * const *, const T *,           \
+                                       T * const *, unsigned long);            \
+  template void inverseRadix8Kernel<T>(const T * const *, const T *,           \
+                                       T * const *, unsigned long);            \
+  template void inverseRadixPKernel<T>(unsigned int, const T * const *,        \
+                                       const T *, T * const *, unsigned long);
+
+INSTANTIATE_KERNELS(float)
+INSTANTIATE_KERNELS(double)
+INSTANTIATE_KERNELS(long double)
@@ -0,0 +1,102 @@
+/*
+ * fft_kernels.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef FFT_KERNELS_HPP_
+#define FFT_KERNELS_HPP_
+
+/*
+ * The kernels work on interleaved complex values (re, im) of scalar type T,
+ * i.e. on the FFTW complex types of float, double and long double.
+ * count is the number of complex values.
+ *
+ * Radix-2 butterfly over contiguous spans:
+ *   low[i]  = even[i] + odd[i] * twiddles[i]
+ *   high[i] = even[i] - odd[i] * twiddles[i]
+ * low may alias even and high may alias odd (in-place merge).
+ */
+template <typename T>
+struct Radix2Kernel
+{
+  typedef void (*type)( const T *     even,
+                        const T *     odd,
+                        const T *     twiddles,
+                        T *           low,
+                        T *           high,
+                        unsigned long count );
+};
+
+/*
+ * Returns the fastest kernel supported by the executing CPU
+ * (AVX-512F, AVX2/FMA or scalar), chosen once at runtime.
+ * long double always uses the scalar kernel.
+ */
+template <typename T>
+typename Radix2Kernel<T>::type selectRadix2Kernel();
+
+template <typename T>
+const char * radix2KernelName();
+
+static const unsigned int maxKernelRadix = 8;
+
+/*
+ * Radix-p butterfly of one distributed merge stage, 2 <= p <= maxKernelRadix:
+ *   a_m           = inputs[m][u] * twiddles[u]^m
+ *   outputs[v][u] = sum_m a_m * exp(-2 pi I m v / p)
+ * outputs[v] may alias inputs[v].
+ */
+template <typename T>
+void radix4Kernel( const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count );
+
+/* two radix-4 butterflies and a radix-2 step instead of the p^2 sum */
+template <typename T>
+void radix8Kernel( const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count );
+
+template <typename T>
+void radixPKernel( unsigned int      radix,
+                   const T * const * inputs,
+                   const T *         twiddles,
+                   T * const *       outputs,
+                   unsigned long     count );
+
+/*
+ * Inverse of the merge butterfly without the factor 1 / p:
+ *   a_m           = sum_v inputs[v][u] * exp(2 pi I m v / p)
+ *   outputs[m][u] = a_m * conj(twiddles[u])^m
+ * outputs[m] may alias inputs[m].
+ */
+template <typename T>
+void inverseRadix2Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count );
+
+template <typename T>
+void inverseRadix4Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count );
+
+template <typename T>
+void inverseRadix8Kernel( const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count );
+
+template <typename T>
+void inverseRadixPKernel( unsigned int      radix,
+                          const T * const * inputs,
+                          const T *         twiddles,
+                          T * const *       outputs,
+                          unsigned long     count );
+
+#endif /* FFT_KERNELS_HPP_ */
@@ -0,0 +1,417 @@
+/*
+ * fft_nd_runtime.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <string.h>
+#include <assert.h>
+#include <cmath>
+#include "fft_nd_runtime.hpp"
+
+//------------------------------------------------------------------------------
+NdDecomposition::NdDecomposition(const unsigned long n[3], decomposition_t type,
+                                 gaspi_rank_t count)
+{
+  for (unsigned int axis = 0; axis < 3; axis++)
+    dims[axis] = n[axis];
+  nodecount = count;
+  valid = true;
+
+  if (type == decomposition_slab)
+  {
+    rows    = nodecount;
+    columns = 1;
+
+    const unsigned int split0[2] = { 0 , 1 }, order0[3] = { 0 , 1 , 2 };
+    const unsigned int split1[2] = { 1 , 0 }, order1[3] = { 1 , 2 , 0 };
+    const unsigned long parts[2] = { rows , columns };
+    addStage(split0, parts, order0, 2);
+    addStage(split1, parts, order1, 1);
+  }
+  else
+  {
+    /* the most square grid, columns <= rows */
+    columns = 1;
+    for (unsigned long c = 1; c * c <= nodecount; c++)
+    {
+      if (nodecount % c == 0)
+        columns = c;
+    }
+    rows = nodecount / columns;
+
+    const unsigned int split0[2] = { 0 , 1 }, order0[3] = { 0 , 1 , 2 };
+    const unsigned int split1[2] = { 0 , 2 }, order1[3] = { 0 , 2 , 1 };
+    const unsigned int split2[2] = { 1 , 2 }, order2[3] = { 2 , 1 , 0 };
+    const unsigned long parts[2] = { rows , columns };
+    addStage(split0, parts, order0, 1);
+    addStage(split1, parts, order1, 1);
+    addStage(split2, parts, order2, 1);
+  }
+}
+
+//------------------------------------------------------------------------------
+void NdDecomposition::addStage(const unsigned int split[2],
+                               const unsigned long parts[2],
+                               const unsigned int order[3],
+                               unsigned int transformRank)
+{
+  std::vector<Box> stage(nodecount);
+
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    if (dims[split[i]] % parts[i] != 0)
+      valid = false;
+  }
+
+  for (gaspi_rank_t r = 0; r < nodecount; r++)
+  {
+    unsigned long part[2] = { r / columns , r % columns };
+    Box & box = stage[r];
+
+    for (unsigned int axis = 0; axis < 3; axis++)
+    {
+      box.start[axis] = 0;
+      box.count[axis] = dims[axis];
+      box.order[axis] = order[axis];
+    }
+    for (unsigned int i = 0; i < 2; i++)
+    {
+      box.count[split[i]] = dims[split[i]] / parts[i];
+      box.start[split[i]] = part[i] * box.count[split[i]];
+    }
+  }
+  boxes.push_back(stage);
+  transformRanks.push_back(transformRank);
+}
+
+//------------------------------------------------------------------------------
+bool NdDecomposition::isValid() const
+{
+  return valid;
+}
+
+//------------------------------------------------------------------------------
+unsigned int NdDecomposition::getStageCount() const
+{
+  return boxes.size();
+}
+
+//------------------------------------------------------------------------------
+const std::vector<Box> & NdDecomposition::getBoxes(unsigned int stage) const
+{
+  return boxes[stage];
+}
+
+//------------------------------------------------------------------------------
+unsigned int NdDecomposition::getTransformRank(unsigned int stage) const
+{
+  return transformRanks[stage];
+}
+
+//------------------------------------------------------------------------------
+unsigned long NdDecomposition::getVolume() const
+{
+  return dims[0] * dims[1] * dims[2];
+}
+
+//------------------------------------------------------------------------------
+unsigned long NdDecomposition::getLocalVolume() const
+{
+  return getVolume() / nodecount;
+}
+
+//------------------------------------------------------------------------------
+unsigned long NdDecomposition::getRows() const
+{
+  return rows;
+}
+
+//------------------------------------------------------------------------------
+unsigned long NdDecomposition::getColumns() const
+{
+  return columns;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Segment: calc buffer (the local part, transformed in place), one receive
+ * buffer per transpose and the send buffer, which holds the gathered
+ * result on the master.
+ */
+template <typename T>
+FftNdRuntime<T>::FftNdRuntime(const unsigned long n[3], decomposition_t type,
+                              gaspi_segment_id_t seg,
+                              const ProcessGroup & processGroup,
+                              unsigned int plannerFlags)
+:group( processGroup ), master_rank( 0 )
+{
+  rank      = group.getRank();
+  nodecount = group.getSize();
+  decomposition = new NdDecomposition( n , type , nodecount );
+  for (unsigned int axis = 0; axis < 3; axis++)
+    dims[axis] = n[axis];
+
+  if (!decomposition->isValid())
+  {
+    std::cerr << "ERROR # FftNdRuntime # the dimensions don't fit the "
+        << decomposition->getRows() << " x " << decomposition->getColumns()
+        << " process grid" << std::endl;
+    exit(2);
+  }
+  localVolume = decomposition->getLocalVolume();
+
+  rdma = new RdmaManager<T>( seg, group );
+  initialOffsets();
+
+  for (unsigned int s = 1; s < decomposition->getStageCount(); s++)
+  {
+    unsigned long recvOffset = rdma->getRecvBuffersOffset()
+        + (s - 1) * SegmentLayout::alignLine(localVolume * sizeof(complex_t));
+    transposes.push_back(new Transpose<T>(rdma, decomposition->getBoxes(s - 1),
+                                          decomposition->getBoxes(s),
+                                          recvOffset,
+                                          rdma->reserveNotifications(nodecount)));
+  }
+  gatherNotifyBase = rdma->reserveNotifications(nodecount);
+
+  createPlans(plannerFlags);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The send buffer of the master grows to the whole result
+ */
+template <typename T>
+void FftNdRuntime<T>::initialOffsets()
+{
+  unsigned long buffersize = localVolume * sizeof(complex_t);
+  unsigned long recvsize   = (decomposition->getStageCount() - 1)
+      * SegmentLayout::alignLine(buffersize);
+
+  rdma->setNodeCount(nodecount);
+  rdma->setLengthperBuffer(localVolume / 2);
+  rdma->createSegment(SegmentLayout(buffersize, recvsize, buffersize,
+                                    rank == master_rank ?
+                                        (nodecount - 1) * buffersize : 0));
+}
+
+//------------------------------------------------------------------------------
+/*
+ * In place plans on the calc buffer, one per stage. Created before the
+ * input is generated since FFTW_MEASURE and above overwrite the array.
+ */
+template <typename T>
+void FftNdRuntime<T>::createPlans(unsigned int plannerFlags)
+{
+  complex_t * work = getLocalData();
+
+  for (unsigned int s = 0; s < decomposition->getStageCount(); s++)
+  {
+    const Box & box = decomposition->getBoxes(s)[rank];
+    unsigned int transformRank = decomposition->getTransformRank(s);
+    int n[3];
+    int length = 1;
+
+    for (unsigned int i = 0; i < transformRank; i++)
+    {
+      n[i] = box.count[box.order[3 - transformRank + i]];
+      length *= n[i];
+    }
+
+    typename FftwTraits<T>::plan_t plan = FftwTraits<T>::planManyDft(
+        transformRank, n, localVolume / length, work, 1, length,
+        work, 1, length, FFTW_FORWARD, plannerFlags);
+    assert(plan);
+    plans.push_back(plan);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftNdRuntime<T>::generateInput()
+{
+  complex_t * work = getLocalData();
+  const Box & box = decomposition->getBoxes(0)[rank];
+  unsigned long volume = decomposition->getVolume();
+  unsigned long i = 0;
+
+  for (unsigned long x = box.start[0]; x < box.start[0] + box.count[0]; x++)
+    for (unsigned long y = box.start[1]; y < box.start[1] + box.count[1]; y++)
+      for (unsigned long z = box.start[2]; z < box.start[2] + box.count[2]; z++)
+      {
+        work[i++] = rdma->generateFakeInput((x * dims[1] + y) * dims[2] + z,
+                                            volume);
+      }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Every rank generates its own box, called before every transform
+ */
+template <typename T>
+void FftNdRuntime<T>::loadInput()
+{
+  generateInput();
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+  rdma->nextEpoch();
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftNdRuntime<T>::startRuntime()
+{
+  forward();
+  gatherResult();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * One transform of the plan on new input
+ */
+template <typename T>
+void FftNdRuntime<T>::execute()
+{
+  loadInput();
+  startRuntime();
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftNdRuntime<T>::forward()
+{
+  FftwTraits<T>::execute(plans[0]);
+
+  for (unsigned int s = 1; s < decomposition->getStageCount(); s++)
+  {
+    gaspi_printf("Transpose %d\n", s);
+    transposes[s - 1]->execute();
+    FftwTraits<T>::execute(plans[s]);
+  }
+  gaspi_printf("Main Computation finished\n");
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The master receives the local parts at rank * localVolume of its send
+ * buffer and sorts them into x, y, z row major order
+ */
+template <typename T>
+void FftNdRuntime<T>::gatherResult()
+{
+  unsigned long buffersize = localVolume * sizeof(complex_t);
+
+  /* the send buffer of the master is free once every rank is done */
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+
+  if (rank != master_rank)
+  {
+    rdma->writeBlockToMaster(rdma->getCalcBufferOffset1(),
+                             rdma->getInitialOffset1() + rank * buffersize,
+                             buffersize, gatherNotifyBase + rank);
+    rdma->waitOnQueues();
+    return;
+  }
+
+  complex_t * result = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+  memcpy(result, getLocalData(), buffersize);
+  rdma->waitOnNotifies( gatherNotifyBase + 1 , nodecount - 1 );
+
+  const std::vector<Box> & boxes =
+      decomposition->getBoxes(decomposition->getStageCount() - 1);
+  Box domain;
+  for (unsigned int axis = 0; axis < 3; axis++)
+  {
+    domain.start[axis] = 0;
+    domain.count[axis] = dims[axis];
+    domain.order[axis] = axis;
+  }
+
+  unsigned long volume = decomposition->getVolume();
+  complex_t * sorted = new complex_t[volume];
+  for (gaspi_rank_t r = 0; r < nodecount; r++)
+  {
+    Transpose<T>::copyRegion(result + r * localVolume, boxes[r],
+                             sorted, domain, boxes[r]);
+  }
+  memcpy(result, sorted, volume * sizeof(complex_t));
+  delete[] sorted;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Local part of the output, stored as getLocalBox()
+ */
+template <typename T>
+typename FftNdRuntime<T>::complex_t * FftNdRuntime<T>::getLocalData()
+{
+  return (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getCalcBufferOffset1());
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+const Box & FftNdRuntime<T>::getLocalBox()
+{
+  return decomposition->getBoxes(decomposition->getStageCount() - 1)[rank];
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftNdRuntime<T>::validateFFT()
+{
+  complex_t * pResult = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+  unsigned long volume = decomposition->getVolume();
+  int n[3] = { (int) dims[0] , (int) dims[1] , (int) dims[2] };
+
+  fftw_complex * values = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * volume);
+  fftw_complex * out = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * volume);
+  fftw_plan plan = fftw_plan_many_dft(3, n, 1, values, NULL, 1, volume,
+      out, NULL, 1, volume, FFTW_FORWARD, FFTW_ESTIMATE);
+  for (unsigned long i = 0; i < volume; i++) {
+    values[i] = rdma->generateFakeInput(i,volume);
+  }
+  fftw_execute(plan);
+
+  gaspi_printf("Result of %lu x %lu x %lu FFT\n", dims[0], dims[1], dims[2]);
+  double diff = 0.0;
+  double max = 0.0;
+  for (unsigned long i = 0; i < volume; i++) {
+    double tmp_diff_real = creal(out[i]) - creal(pResult[i]);
+    double tmp_diff_imag = cimag(out[i]) - cimag(pResult[i]);
+
+    diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
+    diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
+    max = std::abs(creal(out[i])) > std::abs(max) ? creal(out[i]) : max;
+    max = std::abs(cimag(out[i])) > std::abs(max) ? cimag(out[i]) : max;
+  }
+  std::cout << "Relativer Fehler " <<  (double) (std::abs(diff) / std::abs(max)) << "\n";
+  std::cout << "Abweichnung max. " << std::abs(diff) << "\n";
+  std::cout << "max factor " << std::abs(max) << "\n";
+
+  fftw_free(values);
+  fftw_free(out);
+  fftw_destroy_plan(plan);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+FftNdRuntime<T>::~FftNdRuntime()
+{
+  for (unsigned long i = 0; i < transposes.size(); i++)
+    delete transposes[i];
+  for (unsigned long i = 0; i < plans.size(); i++)
+    FftwTraits<T>::destroyPlan(plans[i]);
+  delete rdma;
+  delete decomposition;
+}
+
+//------------------------------------------------------------------------------
+template class FftNdRuntime<float>;
+template class FftNdRuntime<double>;
+template class FftNdRuntime<long double>;
@@ -0,0 +1,106 @@
+/*
+ * fft_nd_runtime.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef FFT_ND_RUNTIME_HPP_
+#define FFT_ND_RUNTIME_HPP_
+#include <vector>
+#include "utils.hpp"
+#include "fftw_traits.hpp"
+#include "rdma_manager.hpp"
+#include "transpose.hpp"
+
+typedef enum Decomposition_t {
+  decomposition_slab, decomposition_pencil
+} decomposition_t;
+
+/*
+ * Boxes of all ranks in every stage of a 2d/3d transform of dims[0] x
+ * dims[1] x dims[2] values (dims[2] = 1 for 2d), x is the slowest axis of
+ * the input. A stage transforms the trailing axes of its storage order,
+ * which are complete on every rank, the stages are joined by transposes.
+ *
+ * slab   : x split over all ranks, transform y and z,
+ *          then y split, transform x.
+ *          At most min(dims[0], dims[1]) ranks.
+ * pencil : ranks form a rows x columns grid, rank = row * columns + column,
+ *          x, y split by row, column, transform z,
+ *          x, z split by row, column, transform y,
+ *          y, z split by row, column, transform x.
+ */
+class NdDecomposition {
+
+public:
+  NdDecomposition(const unsigned long dims[3], decomposition_t type,
+                  gaspi_rank_t nodecount);
+
+  bool isValid() const;
+  unsigned int getStageCount() const;
+  const std::vector<Box> & getBoxes(unsigned int stage) const;
+  unsigned int getTransformRank(unsigned int stage) const;
+  unsigned long getVolume() const;
+  unsigned long getLocalVolume() const;
+  unsigned long getRows() const;
+  unsigned long getColumns() const;
+
+private:
+  unsigned long dims[3];
+  gaspi_rank_t  nodecount;
+  unsigned long rows;
+  unsigned long columns;
+  bool valid;
+  std::vector< std::vector<Box> > boxes;
+  std::vector<unsigned int> transformRanks;
+
+  void addStage(const unsigned int split[2], const unsigned long parts[2],
+                const unsigned int order[3], unsigned int transformRank);
+};
+
+/*
+ * Distributed 2d/3d transform with complex values of precision T. The
+ * output stays in the layout of the last stage, gatherResult() collects
+ * it on the master in natural order.
+ */
+template <typename T>
+class FftNdRuntime {
+
+public:
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  FftNdRuntime(const unsigned long dims[3], decomposition_t type,
+               gaspi_segment_id_t seg, const ProcessGroup & group,
+               unsigned int plannerFlags = FFTW_ESTIMATE);
+  ~FftNdRuntime();
+
+  void loadInput();
+  void execute();
+  void startRuntime();
+  void forward();
+  void gatherResult();
+  complex_t * getLocalData();
+  const Box & getLocalBox();
+  void validateFFT();
+
+private:
+  NdDecomposition * decomposition;
+  RdmaManager<T> * rdma;
+  std::vector<Transpose<T> *> transposes;
+  std::vector<typename FftwTraits<T>::plan_t> plans;
+  unsigned long dims[3];
+  unsigned long localVolume;
+  gaspi_notification_id_t gatherNotifyBase;
+  const ProcessGroup & group;
+  gaspi_rank_t rank;
+  gaspi_rank_t nodecount;
+  gaspi_rank_t master_rank;
+
+  void initialOffsets();
+  void createPlans(unsigned int plannerFlags);
+  void generateInput();
+
+};
+
+#endif /* FFT_ND_RUNTIME_HPP_ */
@@ -8,218 +8,1389 @@
 
 #include <GASPI.h>
 #include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <complex.h>
 #include <cmath>
 #include <assert.h>
 #include "fft_runtime.hpp"
+#include "result_file.hpp"
 
-FftRuntime::FftRuntime(unsigned long vectorlength,
+template <typename T>
+FftRuntime<T>::FftRuntime(unsigned long vectorlength,
 					   unsigned int splitcount,
-					   gaspi_segment_id_t seg )
-:master_rank( 0 )
+					   gaspi_segment_id_t seg,
+					   const ProcessGroup & processGroup,
+					   unsigned int plannerFlags,
+					   unsigned int maxRadix,
+					   bool realinput,
+					   bool withinverse,
+					   unsigned int batchcount,
+					   output_t outputmode,
+					   unsigned int chunkcount )
+:group( processGroup ), master_rank( 0 )
 {
-  gaspi_proc_rank( &rank );
-  gaspi_proc_num( &nodecount );
+  nodecount = group.getSize();
   splitCount = splitcount;
   /*
-   * get the number of communication partner
-   * and store these in the rdma (sorted by iteration)
+   * Initial the portion of the RDMA per Node,
+   * a real signal is transformed as complex vector of half the length
    */
-  levelCount = log2(nodecount);
+  realInput = realinput;
+  withInverse = withinverse;
+  normalized = false;
+  reordered = false;
+  batchCount = batchcount;
+  output = outputmode;
+  /* the pieces of the chunks go round robin over the queues, at least one
+     chunk per queue stripes every transfer over all of them */
+  chunkCount = chunkcount > RdmaManager<T>::getQueueCount() ?
+      chunkcount : RdmaManager<T>::getQueueCount();
+  phase = phase_done;
+  elementSize = batchCount * sizeof(complex_t);
+  nyquist.assign(batchCount, 0);
+  signalLength = vectorlength;
+  totalVectorLength = realInput ? vectorlength / 2 : vectorlength;
+
+  rdma = new RdmaManager<T>( seg, group );
+  rdma->setBatchCount( batchCount );
+  /* with shared memory the node ids are ordered by host */
+  rdma->placeByHost();
+  rank = rdma->getNodeId();
   /*
-   * Initial the portion of the RDMA per Node
+   * factor nodecount into merge stages of radix 5, 3 and powers of two
+   * up to maxRadix and place their receive buffers
    */
-  totalVectorLength = vectorlength;
-
-  rdma = RdmaManager::getInstance();
-  rdma->initial( seg );
+  buildSchedule( maxRadix );
   initialOffsets();
+  initialTransfers();
+  if ( realInput )
+  {
+    initialMirrorTransfers();
+  }
+  initialReorderTransfers();
+  rdma->setRealInput( realInput );
+  compute = new FftComputation<T>(rdma, rdma->getBufferLength() * splitCount,
+                                  plannerFlags, withInverse,
+                                  stages[0].outputOffset - rdma->getCalcBufferOffset1());
+  assert(compute);
+}
+//------------------------------------------------------------------------------
+/*
+ * One transform of the plan on new input, the result ends up where the
+ * output mode says, with withInverse the signal of the round trip on the
+ * master
+ */
+template <typename T>
+void FftRuntime<T>::execute(bool normalize)
+{
+  start();
+  wait();
 
-  nodes = new int[levelCount];
-  assert(nodes);
+  if (withInverse)
+  {
+    inverse(normalize);
+    gatherSignal();
+  }
+}
+//------------------------------------------------------------------------------
+/*
+ * calc buffers and the receive buffers of the schedule on every rank.
+ * The initial buffers of a rank hold the vectors of its subtree of the
+ * distribution, the master also collects the spectrum (with real input
+ * and X[M]) or the signal of the round trip from initial buffer 1 on.
+ */
+template <typename T>
+void FftRuntime<T>::initialOffsets()
+{
+  unsigned long bufferLengthPerNode = (totalVectorLength
+      / (nodecount * splitCount));
+
+  unsigned long buffersize = bufferLengthPerNode * elementSize;
 
-  for (int i = levelCount - 1; i >= 0; i--) {
-    nodes[i] = getActualMergeNodeID(i);
+  unsigned long initalSize = buffersize * splitCount;
+
+  unsigned long gatherSize = 0;
+  if (withInverse)
+    gatherSize = totalVectorLength * elementSize;
+  else if (output == output_gathered)
+    gatherSize = (realInput ? totalVectorLength + 1 : totalVectorLength)
+                 * elementSize;
+
+  /* with an input file the tail stages the slice read for the other ranks */
+  unsigned long tailSize = rdma->hasInputFile() ? initalSize
+      : (scatter_span(rank, master_rank, nodecount) - 1) * initalSize;
+  if (rank == master_rank && gatherSize > initalSize + tailSize)
+    tailSize = gatherSize - initalSize;
+
+  rdma->setLengthperBuffer(bufferLengthPerNode);
+
+  rdma->setNodeCount(nodecount);
+
+  /* direct stages alternate between two calc buffers */
+  unsigned long calcSize = 2 * buffersize;
+  mergeBufferOffset = 0;
+  if (RdmaManager<T>::hasSharedMemory() && !withInverse && stages.size() > 1)
+  {
+    mergeBufferOffset = SegmentLayout::alignLine(calcSize);
+    calcSize = mergeBufferOffset + initalSize;
+  }
+
+  rdma->createSegment(SegmentLayout(calcSize, recvBytes,
+                                    initalSize, tailSize));
+}
+
+//------------------------------------------------------------------------------
+bool mergeRadices(unsigned long nodecount, unsigned int maxRadix,
+                  std::vector<unsigned int> & radices)
+{
+  static const unsigned int oddRadices[] = { 5, 3 };
+
+  radices.clear();
+  for (unsigned int i = 0; i < 2; i++)
+  {
+    while (nodecount % oddRadices[i] == 0)
+    {
+      radices.push_back(oddRadices[i]);
+      nodecount /= oddRadices[i];
+    }
+  }
+  if ((nodecount & (nodecount - 1)) != 0)
+    return false;
+
+  unsigned int levels    = (unsigned int) log2(nodecount);
+  unsigned int radixBits = (unsigned int) log2(maxRadix);
+  unsigned int firstBits = levels % radixBits;
+
+  if (firstBits != 0)
+  {
+    radices.push_back(1U << firstBits);
+  }
+  for (unsigned int i = 0; i < levels / radixBits; i++)
+  {
+    radices.push_back(1U << radixBits);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Stages of the radices of mergeRadices(), equal radices follow each other
+ * so most stages keep the block of the own sub-group local. With ranks
+ * placed by host the radices which fit into a host are merged first.
+ * After a change of radix the requested blocks cross the blocks of the
+ * previous stage and are fetched piecewise, the own pieces included.
+ * The receive offsets are relative to the receive buffers until
+ * initialTransfers() rebases them.
+ */
+template <typename T>
+void FftRuntime<T>::buildSchedule(unsigned int maxRadix)
+{
+  unsigned long localLength = totalVectorLength / nodecount;
+
+  std::vector<unsigned int> radices;
+  if (!mergeRadices(nodecount, maxRadix, radices))
+  {
+    std::cerr << "ERROR # buildSchedule() # " << nodecount
+              << " ranks are no product of 2, 3 and 5" << std::endl;
+    exit(2);
   }
 
-  rdma->initialNodeEntries(nodes, levelCount);
   /*
-   * send data to the worker nodes
+   * radices which divide the ranks per host go first, the groups of the
+   * stages up to a product of the ranks per host stay on the host
    */
-  compute = new FftComputation(rdma->getBufferLength() * splitCount);
-  assert(compute);
-  gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK);
-  if ( rank == master_rank )
+  unsigned long hostRanks = rdma->getHostRanks();
+  std::vector<unsigned int> hostRadices, otherRadices;
+  for (unsigned int i = 0; i < radices.size(); i++)
   {
-    rdma->distributeVectors(splitCount, totalVectorLength);
+    if (hostRanks % radices[i] == 0)
+    {
+      hostRadices.push_back(radices[i]);
+      hostRanks /= radices[i];
+    }
+    else
+      otherRadices.push_back(radices[i]);
   }
-  else
+  radices = hostRadices;
+  radices.insert(radices.end(), otherRadices.begin(), otherRadices.end());
+
+  stages.clear();
+  MergeStage initial;
+  initial.radix         = 1;
+  initial.stride        = nodecount;
+  initial.groupsize     = 1;
+  initial.blocklength   = localLength;
+  initial.mergeLength   = localLength;
+  initial.kmin          = 0;
+  initial.stable        = true;
+  initial.piecesPerSlot = 0;
+  initial.chunks        = 1;
+  initial.chunkLength   = localLength;
+  initial.recvOffset    = 0;
+  initial.notifyBase    = 0;
+  initial.notifyRange   = 0;
+  initial.inverseNotifyBase  = 0;
+  initial.inverseNotifyRange = 0;
+  initial.inverseNotifyCount = 0;
+  initial.direct        = false;
+  initial.outputOffset  = 0;
+  initial.releaseNotifyBase = 0;
+  initial.releaseCount  = 0;
+  stages.push_back(initial);
+
+  /* the parent and the slices of the input file exchange */
+  distributionNotify = rdma->reserveNotifications(1 + nodecount);
+  /* one id per possible child in the scatter tree */
+  gaspi_notification_id_t readyRange = 1;
+  while ((1UL << readyRange) < nodecount)
+    readyRange++;
+  readyNotify = rdma->reserveNotifications(readyRange);
+  recvBytes = 0;
+
+  for (unsigned int s = 1; s <= radices.size(); s++)
+  {
+    const MergeStage & prev = stages[s - 1];
+    MergeStage stage;
+
+    stage.radix       = radices[s - 1];
+    stage.stride      = prev.stride / stage.radix;
+    stage.groupsize   = prev.groupsize * stage.radix;
+    stage.blocklength = localLength / stage.radix;
+    stage.mergeLength = totalVectorLength / stage.stride;
+    stage.kmin        = 0;
+    stage.stable      = (s == 1) || (stage.radix == prev.radix);
+
+    if (prev.blocklength % stage.blocklength == 0)
+      stage.piecesPerSlot = 1;
+    else
+      stage.piecesPerSlot = (stage.blocklength + prev.blocklength - 1)
+                            / prev.blocklength + 1;
+
+    unsigned int slots = stage.stable ? stage.radix - 1 : stage.radix;
+
+    /* chunks of a multiple of the vector width of the kernels */
+    stage.chunkLength = ((stage.blocklength + chunkCount - 1) / chunkCount + 7) & ~7UL;
+    if (stage.chunkLength > stage.blocklength)
+      stage.chunkLength = stage.blocklength;
+    stage.chunks = (stage.blocklength + stage.chunkLength - 1) / stage.chunkLength;
+
+    stage.recvOffset  = SegmentLayout::alignLine(recvBytes);
+    stage.notifyRange = slots * stage.piecesPerSlot;
+    stage.notifyBase  = rdma->reserveNotifications(stage.notifyRange * stage.chunks);
+
+    /* the readers of a direct stage identify themselves by their position */
+    stage.direct       = false;
+    stage.outputOffset = 0;
+    stage.releaseCount = 0;
+    stage.releaseNotifyBase = 0;
+    if (RdmaManager<T>::hasSharedMemory() && !withInverse)
+      stage.releaseNotifyBase = rdma->reserveNotifications(stage.groupsize);
+
+    recvBytes = stage.recvOffset + slots * stage.blocklength * elementSize;
+
+    stages.push_back(stage);
+  }
+  /* one id per queue and rank, the result is striped over the queues */
+  gatherNotifyBase = rdma->reserveNotifications(nodecount * RdmaManager<T>::getQueueCount());
+
+  if (realInput)
+  {
+    mirrorOffset      = SegmentLayout::alignLine(recvBytes);
+    edgeOffset        = SegmentLayout::alignLine(mirrorOffset + localLength * elementSize);
+    recvBytes         = edgeOffset + stages.back().radix * elementSize;
+    mirrorNotifyBase  = rdma->reserveNotifications(stages.back().radix + 1);
+    mirrorNotifyCount = 0;
+  }
+
+  /* a returning piece is identified by its sender position and piece */
+  for (unsigned int s = 1; withInverse && s < stages.size(); s++)
   {
-    rdma->waitOnNotifies( master_rank + 10 , 1 );
+    MergeStage & stage = stages[s];
+    stage.inverseNotifyRange = stage.groupsize * stage.piecesPerSlot;
+    stage.inverseNotifyBase  = rdma->reserveNotifications(stage.inverseNotifyRange);
+    stage.inverseNotifyCount = 0;
   }
+
+  reorderNotifyBase  = rdma->reserveNotifications(stages.back().radix);
+  reorderNotifyCount = 0;
 }
+
 //------------------------------------------------------------------------------
-void FftRuntime::initialOffsets()
+/*
+ * In the inverse the pieces a rank sent in stage s return into the
+ * receive buffers of stage s, placed by their calc buffer offset. In
+ * stable stages the own block never left and is skipped.
+ */
+template <typename T>
+unsigned long FftRuntime<T>::returnOffset(unsigned int stage, unsigned long node,
+                                          unsigned long offset)
 {
-  unsigned long bufferLengthPerNode = (totalVectorLength
-      / (nodecount * splitCount));
+  const MergeStage & st = stages[stage];
+  if (!st.stable)
+    return offset;
 
-  unsigned long buffersize = bufferLengthPerNode * sizeof(fftw_complex);
+  unsigned long position, ownOffset;
+  locateInGroup(stage - 1, positionInGroup(stage, node) * st.blocklength,
+                position, ownOffset);
+  return offset < ownOffset ? offset : offset - st.blocklength;
+}
 
-  rdma->setLengthperBuffer(bufferLengthPerNode);
+//------------------------------------------------------------------------------
+/*
+ * Receive slot of the sub-group group for a rank of sub-group ownGroup.
+ * In stable stages the own sub-group gets no slot (returns -1) since its
+ * block is read in place from the calc buffer.
+ */
+template <typename T>
+int FftRuntime<T>::slotOfGroup(unsigned int stage, unsigned int group,
+                            unsigned int ownGroup)
+{
+  if (!stages[stage].stable)
+    return group;
+  if (group == ownGroup)
+    return -1;
+  return group < ownGroup ? group : group - 1;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Position in the group and offset in the calc buffer of element k of
+ * a group transform after the given stage
+ */
+template <typename T>
+void FftRuntime<T>::locateInGroup(unsigned int stage, unsigned long k,
+                               unsigned long & position, unsigned long & offset)
+{
+  const MergeStage & st = stages[stage];
+  unsigned long span = st.groupsize * st.blocklength;
 
-  rdma->setCalcOffsets((unsigned long) 0, buffersize);
+  position = (k % span) / st.blocklength;
+  offset   = (k / span) * st.blocklength + (k % st.blocklength);
+}
 
-  rdma->setRecvBuffersOffset( 2 * buffersize );
+//------------------------------------------------------------------------------
+/*
+ * A rank of sub-group m (m = (rank / stride) % radix) at position q of
+ * its previous group moves to position m * previous groupsize + q.
+ * For radix-2 stages this yields the bit reversed rank.
+ */
+template <typename T>
+unsigned long FftRuntime<T>::positionInGroup(unsigned int stage, unsigned long node)
+{
+  unsigned long position = 0;
+  for (unsigned int s = 1; s <= stage; s++)
+  {
+    unsigned long subgroup = (node / stages[s].stride) % stages[s].radix;
+    position += subgroup * stages[s - 1].groupsize;
+  }
+  return position;
+}
 
-  rdma->setNodeCount(nodecount);
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long FftRuntime<T>::rankInGroup(unsigned int stage, unsigned long group,
+                                      unsigned long position)
+{
+  for (unsigned int s = stage; s > 0; s--)
+  {
+    unsigned long prevGroupsize = stages[s - 1].groupsize;
+    group    += (position / prevGroupsize) * stages[s].stride;
+    position  = position % prevGroupsize;
+  }
+  return group;
+}
 
-  unsigned int recvBufferCount = levelCount;
+//------------------------------------------------------------------------------
+/*
+ * A stage is direct if every rank mapped the segments of all members of
+ * its group, with placeByHost() these are the first stages up to a group
+ * stride of the number of hosts. The calc buffers are assigned backwards
+ * from the last stage, which writes calc buffer 1.
+ */
+template <typename T>
+void FftRuntime<T>::selectDirectStages()
+{
+  unsigned long calcBase = rdma->getCalcBufferOffset1();
+  unsigned long shared = 0;
 
-  unsigned long initalSize = buffersize * splitCount;
+  if (mergeBufferOffset != 0)
+  {
+    for (unsigned int s = 1; s < stages.size(); s++)
+    {
+      bool mapped = true;
+      for (unsigned long q = 0; q < stages[s].groupsize; q++)
+      {
+        if (rdma->getNodeSegment(rankInGroup(s, rank % stages[s].stride, q)) == NULL)
+          mapped = false;
+      }
+      if (mapped)
+        shared |= 1UL << s;
+    }
 
-  unsigned long initialOffset1 = (2 * buffersize) + recvBufferCount * buffersize;
+    std::vector<unsigned long> flags(nodecount);
+    gaspi_allgather_ulong(shared, &flags[0], rank, nodecount, group.getGroup());
+    for (unsigned int r = 0; r < nodecount; r++)
+      shared &= flags[r];
+  }
 
-  unsigned long initialOffset2 = initialOffset1 + initalSize;
+  stages.back().outputOffset = calcBase;
+  for (unsigned int s = stages.size() - 1; s > 0; s--)
+  {
+    MergeStage & stage = stages[s];
 
-  rdma->setInitialOffsets(initialOffset1, initialOffset2);
+    stage.direct = ((shared >> s) & 1) != 0;
+    if (!stage.direct)
+      stages[s - 1].outputOffset = stage.outputOffset;
+    else if (stage.outputOffset == calcBase)
+      stages[s - 1].outputOffset = calcBase + mergeBufferOffset;
+    else
+      stages[s - 1].outputOffset = calcBase;
+  }
 
+  if (!RdmaManager<T>::hasSharedMemory())
+    return;
+  for (unsigned int s = 1; s < stages.size(); s++)
+  {
+    gaspi_printf("merge stage %2u (radix %u) from : %s\n", s, stages[s].radix,
+                 stages[s].direct ? "peer calc buffers" : "receive buffers");
+  }
 }
 
 //------------------------------------------------------------------------------
-int FftRuntime::getActualMergeNodeID(int expOf2)
+/*
+ * Stage s: the rank at position q of the new group computes the outputs
+ *   Z[v * mergeLength / radix + q * blocklength + u]
+ * from X_m[q * blocklength + u] of every sub-group m. Those input ranges
+ * are looked up in the layout of stage s-1 and requested piecewise.
+ */
+template <typename T>
+void FftRuntime<T>::initialTransfers()
 {
-  int neighbour = -1;
-  int border = (int) pow(2.0, expOf2);
-  for (int i = border; i < nodecount; i += ((int) pow(2.0, expOf2 + 1))) {
-    if (rank < i) {
-      neighbour = rank + border;
-      break;
-    } else if (rank < (i + border)) {
-      neighbour = rank - border;
-      break;
+  unsigned long recvBase = rdma->getRecvBuffersOffset();
+  unsigned long calcBase = rdma->getCalcBufferOffset1();
+  unsigned long sendBase = rdma->getInitialOffset1();
+
+  selectDirectStages();
+
+  for (unsigned int s = 1; s < stages.size(); s++)
+  {
+    MergeStage & stage = stages[s];
+    const MergeStage & prev = stages[s - 1];
+    /* the result of the previous stage */
+    unsigned long inBase = prev.outputOffset;
+
+    stage.recvOffset += recvBase;
+
+    unsigned long group    = rank % stage.stride;
+    unsigned long position = positionInGroup(s, rank);
+    unsigned int  ownGroup = (rank / stage.stride) % stage.radix;
+
+    stage.kmin = position * stage.blocklength;
+    stage.inputOffsets.assign(stage.radix, 0);
+    stage.inputNodes.assign(stage.radix, rank);
+    stage.releases.clear();
+    stage.releaseCount = 0;
+    stage.notifyCounts.assign(stage.chunks, 0);
+    stage.sends.clear();
+    stage.sendsReady.assign(prev.chunks, 0);
+    stage.inverseNotifyCount = 0;
+    stage.inverseSends.clear();
+    stage.unpacks.clear();
+
+    /* receiving side */
+    for (unsigned int m = 0; m < stage.radix; m++)
+    {
+      int slot = slotOfGroup(s, m, ownGroup);
+      unsigned long k   = position * stage.blocklength;
+      unsigned long end = k + stage.blocklength;
+
+      if (slot < 0)
+      {
+        unsigned long srcPosition, srcOffset;
+        locateInGroup(s - 1, k, srcPosition, srcOffset);
+        stage.inputOffsets[m] = inBase + srcOffset * elementSize;
+        continue;
+      }
+
+      stage.inputOffsets[m] = stage.recvOffset
+          + slot * stage.blocklength * elementSize;
+
+      unsigned long firstPosition, firstOffset;
+      locateInGroup(s - 1, k, firstPosition, firstOffset);
+      if (stage.direct
+          && prev.blocklength - (k % prev.blocklength) >= stage.blocklength)
+      {
+        /* one piece, merged in place from the calc buffer of its rank */
+        unsigned long srcRank = rankInGroup(s - 1, group + m * stage.stride,
+                                            firstPosition);
+        stage.inputNodes[m]   = srcRank;
+        stage.inputOffsets[m] = inBase + firstOffset * elementSize;
+
+        if (srcRank != rank)
+        {
+          typename RdmaManager<T>::TransferEntry entry;
+          entry.nodeid       = srcRank;
+          entry.localOffset  = 0;
+          entry.remoteOffset = 0;
+          entry.size         = 0;
+          entry.notifyId     = stage.releaseNotifyBase + position;
+          stage.releases.push_back(entry);
+        }
+      }
+
+      unsigned long begin = k;
+      unsigned int  piece = 0;
+
+      while (k < end)
+      {
+        unsigned long srcPosition, srcOffset;
+        locateInGroup(s - 1, k, srcPosition, srcOffset);
+        unsigned long length = prev.blocklength - (k % prev.blocklength);
+        if (length > end - k)
+          length = end - k;
+
+        unsigned long srcRank = rankInGroup(s - 1, group + m * stage.stride,
+                                            srcPosition);
+        for (unsigned long c = (k - begin) / stage.chunkLength;
+             srcRank != rank && c * stage.chunkLength < k - begin + length; c++)
+        {
+          stage.notifyCounts[c]++;
+        }
+
+        if (withInverse)
+        {
+          /* the inverse merge leaves the piece in the send buffer */
+          typename RdmaManager<T>::TransferEntry entry;
+          entry.nodeid       = srcRank;
+          entry.localOffset  = sendBase
+              + (slot * stage.blocklength + (k - begin)) * elementSize;
+          entry.remoteOffset = stage.recvOffset
+              + returnOffset(s, srcRank, srcOffset) * elementSize;
+          entry.size         = length * elementSize;
+          entry.notifyId     = stage.inverseNotifyBase
+              + position * stage.piecesPerSlot + piece;
+          stage.inverseSends.push_back(entry);
+        }
+        k += length;
+        piece++;
+      }
+    }
+
+    /* sending side, sorted by the chunk of the previous stage they read */
+    unsigned long ownPosition = positionInGroup(s - 1, rank);
+    std::vector< std::vector<typename RdmaManager<T>::TransferEntry> >
+        ready(prev.chunks);
+
+    for (unsigned long dest = 0; dest < stage.groupsize; dest++)
+    {
+      unsigned long destRank  = rankInGroup(s, group, dest);
+      unsigned int  destGroup = (destRank / stage.stride) % stage.radix;
+      int slot = slotOfGroup(s, ownGroup, destGroup);
+
+      if (slot < 0)
+        continue;
+
+      unsigned long begin = dest * stage.blocklength;
+      unsigned long end   = begin + stage.blocklength;
+      unsigned int  piece = 0;
+
+      for (unsigned long k = begin; k < end; piece++)
+      {
+        unsigned long srcPosition, srcOffset;
+        locateInGroup(s - 1, k, srcPosition, srcOffset);
+        unsigned long length = prev.blocklength - (k % prev.blocklength);
+        if (length > end - k)
+          length = end - k;
+
+        /* a direct piece of a whole block is only announced */
+        bool inPlace = stage.direct && k == begin && length == end - begin;
+
+        if (srcPosition == ownPosition && !(inPlace && destRank == rank))
+        {
+          typename RdmaManager<T>::TransferEntry entry;
+          unsigned long t = srcOffset % prev.blocklength;
+
+          if (inPlace)
+            stage.releaseCount++;
+
+          for (unsigned long u = k - begin; u < k - begin + length; )
+          {
+            unsigned long c    = u / stage.chunkLength;
+            unsigned long next = (c + 1) * stage.chunkLength < k - begin + length ?
+                (c + 1) * stage.chunkLength : k - begin + length;
+            unsigned long last = t + (next - (k - begin)) - 1;
+
+            entry.nodeid       = destRank;
+            entry.localOffset  = inBase
+                + (srcOffset + u - (k - begin)) * elementSize;
+            entry.remoteOffset = stage.recvOffset
+                + (slot * stage.blocklength + u) * elementSize;
+            entry.size         = inPlace ? 0 : (next - u) * elementSize;
+            entry.notifyId     = stage.notifyBase + c * stage.notifyRange
+                + slot * stage.piecesPerSlot + piece;
+            ready[last / prev.chunkLength].push_back(entry);
+            u = next;
+          }
+
+          if (withInverse)
+          {
+            /* local copy of the returned piece into the calc buffer */
+            entry.nodeid       = rank;
+            entry.remoteOffset = calcBase + srcOffset * elementSize;
+            entry.localOffset  = stage.recvOffset
+                + returnOffset(s, rank, srcOffset) * elementSize;
+            entry.size         = length * elementSize;
+            stage.unpacks.push_back(entry);
+
+            if (destRank != rank)
+              stage.inverseNotifyCount++;
+          }
+        }
+        k += length;
+      }
+    }
+
+    for (unsigned int c = 0; c < prev.chunks; c++)
+    {
+      stage.sends.insert(stage.sends.end(), ready[c].begin(), ready[c].end());
+      stage.sendsReady[c] = stage.sends.size();
     }
   }
-  if (neighbour == -1) {
-    std::cerr << "ERROR # getActualMergeNodeID #Can't find a merge neighbor"
-        << std::endl;
-    return -1;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The rank at position q of the final group needs Z[M-k] for its outputs
+ * k = j * M / radix + q * blocklength + t. For t > 0 it lies in block
+ * radix-1-j of position groupsize-1-q at offset blocklength-t, so that
+ * rank sends its whole calc buffer. For t = 0 it is the first element of
+ * block radix-1-j of position groupsize-q, or of block (radix-j) % radix
+ * of position 0 for q = 0. Both relations are symmetric, the partners
+ * are also the sources.
+ */
+template <typename T>
+void FftRuntime<T>::initialMirrorTransfers()
+{
+  const MergeStage & last = stages.back();
+  unsigned int lastStage  = stages.size() - 1;
+  unsigned long calcBase  = rdma->getCalcBufferOffset1();
+  unsigned long recvBase  = rdma->getRecvBuffersOffset();
+  unsigned long groupsize = last.groupsize;
+  unsigned long position  = positionInGroup(lastStage, rank);
+
+  mirrorOffset += recvBase;
+  edgeOffset   += recvBase;
+
+  unsigned long mirrorPosition = groupsize - 1 - position;
+  unsigned long edgePosition   = (groupsize - position) % groupsize;
+  unsigned long mirrorRank     = rankInGroup(lastStage, 0, mirrorPosition);
+  unsigned long edgeRank       = rankInGroup(lastStage, 0, edgePosition);
+
+  mirrorSends.clear();
+
+  typename RdmaManager<T>::TransferEntry entry;
+  entry.nodeid       = mirrorRank;
+  entry.localOffset  = calcBase;
+  entry.remoteOffset = mirrorOffset;
+  entry.size         = last.radix * last.blocklength * elementSize;
+  entry.notifyId     = mirrorNotifyBase;
+  mirrorSends.push_back(entry);
+
+  for (unsigned int i = 0; i < last.radix; i++)
+  {
+    unsigned int j = edgePosition > 0 ? last.radix - 1 - i
+                                      : (last.radix - i) % last.radix;
+    entry.nodeid       = edgeRank;
+    entry.localOffset  = calcBase + i * last.blocklength * elementSize;
+    entry.remoteOffset = edgeOffset + j * elementSize;
+    entry.size         = elementSize;
+    entry.notifyId     = mirrorNotifyBase + 1 + j;
+    mirrorSends.push_back(entry);
   }
-  return neighbour;
+
+  mirrorNotifyCount = (mirrorRank != rank ? 1 : 0)
+                    + (edgeRank != rank ? last.radix : 0);
 }
 
 //------------------------------------------------------------------------------
-int FftRuntime::calcReverseBitOrder(int number)
+/*
+ * The last stage has a single group of all ranks, so the chunks of the
+ * spectrum are bl = blocklength elements long and the rank at position q
+ * holds the chunks j * nodecount + q.
+ */
+template <typename T>
+void FftRuntime<T>::initialReorderTransfers()
 {
-  int num = number, i, h;
-  int digits = levelCount;
-  for (h = i = 0; i < digits; i++) {
-    h = h << 1;
-    h += (num & 1);
-    num >>= 1;
+  const MergeStage & last = stages.back();
+  unsigned int lastStage  = stages.size() - 1;
+  unsigned long calcBase  = rdma->getCalcBufferOffset1();
+  unsigned long destBase  = rdma->getInitialOffset1();
+  unsigned long blocksize = last.blocklength * elementSize;
+  unsigned long position  = positionInGroup(lastStage, rank);
+
+  reorderSends.clear();
+  reorderNotifyCount = 0;
+
+  for (unsigned int j = 0; j < last.radix; j++)
+  {
+    unsigned long chunk = j * last.groupsize + position;
+
+    typename RdmaManager<T>::TransferEntry entry;
+    entry.nodeid       = chunk / last.radix;
+    entry.localOffset  = calcBase + j * blocksize;
+    entry.remoteOffset = destBase + (chunk % last.radix) * blocksize;
+    entry.size         = blocksize;
+    entry.notifyId     = reorderNotifyBase + chunk % last.radix;
+    reorderSends.push_back(entry);
+  }
+
+  for (unsigned int i = 0; i < last.radix; i++)
+  {
+    unsigned long chunk = rank * last.radix + i;
+    if (rankInGroup(lastStage, 0, chunk % last.groupsize) != rank)
+      reorderNotifyCount++;
   }
-  return h;
 }
 
 //------------------------------------------------------------------------------
-unsigned long FftRuntime::getStartPosInGroup(int exponent)
+template <typename T>
+void FftRuntime<T>::startRuntime()
+{
+  forward();
+  gatherSpectrum();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Forward transform, the result stays distributed over the calc buffers
+ */
+template <typename T>
+void FftRuntime<T>::forward()
+{
+  beginForward(output_distributed);
+  progress(true);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Starts a transform on new input without waiting for it, the result ends
+ * up where the output mode says once test() returned true or wait()
+ * returned. With withInverse only the forward part is started.
+ * The ranks report up the scatter tree that they are done with the
+ * previous transform, the scatter of the new input down the tree then
+ * starts it, both are phases of progress().
+ */
+template <typename T>
+void FftRuntime<T>::start()
+{
+  pendingOutput = withInverse ? output_distributed : output;
+  rdma->nextEpoch();
+  phase = phase_ready;
+  setWait(readyNotify, rdma->scatterChildCount(), rdma->scatterChildCount(), false);
+  progress(false);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The subtree of the rank is ready, report to the parent and wait on the
+ * input from it
+ */
+template <typename T>
+void FftRuntime<T>::enterInput()
+{
+  rdma->notifyScatterParent(readyNotify);
+  phase = phase_input;
+  setWait(distributionNotify, 1, rdma->scatterNotifyCount(), false);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Forwards the input to the children, with an input file reads the slice
+ * of the rank and waits on the slices of the others. The queue wait of
+ * the first merge stage covers the forwarded writes.
+ */
+template <typename T>
+void FftRuntime<T>::scatterInput()
 {
-  int groupsize = nodecount / pow(2.0, exponent);
-  int pos = calcReverseBitOrder(rank);
-  unsigned long kmin = pos - (((int) (pos / groupsize)) * groupsize);
-  return kmin * rdma->getBufferLength();
+  rdma->scatterVectors(splitCount, totalVectorLength, distributionNotify);
+  phase = phase_exchange;
+  setWait(distributionNotify + 1, nodecount, rdma->exchangeNotifyCount(), false);
 }
 
 //------------------------------------------------------------------------------
-void FftRuntime::startRuntime()
+/*
+ * Advances the started transform as far as the arrived notifications
+ * allow, returns true when it is complete
+ */
+template <typename T>
+bool FftRuntime<T>::test()
 {
+  return progress(false);
+}
 
-  int levelcounter = levelCount - 1;
+//------------------------------------------------------------------------------
+template <typename T>
+void FftRuntime<T>::wait()
+{
+  progress(true);
+}
 
+//------------------------------------------------------------------------------
+/*
+ * Local FFT and the sends of the first stage, target is the output phase
+ * after the merge stages
+ */
+template <typename T>
+void FftRuntime<T>::beginForward(output_t target)
+{
+  reordered = false;
+  pendingOutput = target;
   compute->calculateFftw();
-  //----------------------------------------------------------------------------
 
-  while (0 <= levelcounter)
+  if (stages.size() > 1)
   {
+    rdma->writeTransfers(stages[1].sends);
+  }
+  currentStage = 1;
+  currentChunk = 0;
+  enterMerge();
+}
 
-    int mergeNode = getActualMergeNodeID(levelcounter);
+//------------------------------------------------------------------------------
+template <typename T>
+void FftRuntime<T>::setWait(gaspi_notification_id_t base,
+                            gaspi_notification_id_t range,
+                            unsigned int count, bool queues)
+{
+  waitBase   = base;
+  waitRange  = range;
+  waitCount  = count;
+  waitQueues = queues;
+}
 
-    if (rank < mergeNode) {
-      rdma->sendbuffer = calc_buffer2;
-      rdma->writeVectorToNode(levelcounter);
-      unsigned long kmin = getStartPosInGroup(levelcounter);
-      unsigned long mergeLength = totalVectorLength / pow(2.0, levelcounter);
-      compute->calculateTwiddles(kmin, mergeLength);
-    } else {
-      rdma->sendbuffer = calc_buffer1;
-      rdma->writeVectorToNode(levelcounter);
-      unsigned long kmin = getStartPosInGroup(levelcounter);
-      unsigned long mergeLength = totalVectorLength / pow(2.0, levelcounter);
-      compute->calculateTwiddles(kmin, mergeLength);
+//------------------------------------------------------------------------------
+/*
+ * Runs the step of the current phase whenever its notifications (and own
+ * sends) completed, until the transform is done. Without block it returns
+ * false at the first missing notification.
+ */
+template <typename T>
+bool FftRuntime<T>::progress(bool block)
+{
+  while (phase != phase_done)
+  {
+    if (!rdma->testNotifyRange(waitBase, waitRange, waitCount, block))
+      return false;
+    if (waitQueues)
+    {
+      if (!rdma->testQueues(block))
+        return false;
+      waitQueues = false;
     }
 
-    gaspi_printf("Wait on Notify %d\n",levelcounter);
-    rdma->waitOnNotifies( levelcounter , 1 );
-    gaspi_wait( 0 , GASPI_BLOCK );
-    compute->radix2FFT(levelcounter);
+    if (phase == phase_ready)
+      enterInput();
+    else if (phase == phase_input)
+      scatterInput();
+    else if (phase == phase_exchange)
+      beginForward(pendingOutput);
+    else if (phase == phase_merge)
+      mergeChunk();
+    else if (phase == phase_release)
+      enterMerge();
+    else if (phase == phase_mirror)
+      splitReal();
+    else
+      finishOutput();
+  }
+  return true;
+}
 
-    levelcounter--;
+//------------------------------------------------------------------------------
+/*
+ * Waits on chunk currentChunk of stage currentStage, the own sends of the
+ * stage read the calc buffer, so they have to complete before the first
+ * chunk is merged
+ */
+template <typename T>
+void FftRuntime<T>::enterMerge()
+{
+  if (currentStage >= stages.size())
+  {
+    enterMirror();
+    return;
   }
 
+  const MergeStage & stage = stages[currentStage];
+  unsigned int c = currentChunk;
+
+  if (c == 0)
+  {
+    compute->calculateTwiddles(stage.kmin, stage.mergeLength, stage.blocklength);
+    gaspi_printf("Wait on stage %d\n", currentStage);
+  }
+  phase = phase_merge;
+  setWait(stage.notifyBase + c * stage.notifyRange, stage.notifyRange,
+          stage.notifyCounts[c], c == 0);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftRuntime<T>::mergeChunk()
+{
+  char * base = (char *) rdma->getRdmaPointer();
+  const complex_t * inputs[maxKernelRadix];
+  const MergeStage & stage = stages[currentStage];
+  unsigned int c = currentChunk;
+  unsigned long begin = c * stage.chunkLength;
+  unsigned long count = stage.blocklength - begin < stage.chunkLength ?
+      stage.blocklength - begin : stage.chunkLength;
+
+  for (unsigned int m = 0; m < stage.radix; m++)
+  {
+    inputs[m] = (const complex_t *) (rdma->getNodeSegment(stage.inputNodes[m])
+                                     + stage.inputOffsets[m]);
+  }
+  compute->radixMerge(stage.radix, inputs,
+                      (complex_t *) (base + stage.outputOffset),
+                      stage.blocklength, begin, count);
+
+  /* the sends of the next stage which only read merged chunks */
+  if (currentStage + 1 < stages.size())
+  {
+    const MergeStage & next = stages[currentStage + 1];
+    rdma->writeTransfers(next.sends, c > 0 ? next.sendsReady[c - 1] : 0,
+                         next.sendsReady[c]);
+  }
+
+  if (++currentChunk == stage.chunks)
+  {
+    currentChunk = 0;
+    if (stage.direct)
+    {
+      enterRelease();
+      return;
+    }
+    currentStage++;
+  }
+  enterMerge();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * After a direct stage: tells the peers it read from that they may
+ * overwrite their calc buffer and waits until its own readers are done
+ */
+template <typename T>
+void FftRuntime<T>::enterRelease()
+{
+  const MergeStage & stage = stages[currentStage];
+
+  rdma->writeTransfers(stage.releases);
+  phase = phase_release;
+  setWait(stage.releaseNotifyBase, stage.groupsize, stage.releaseCount, false);
+  currentStage++;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Real input: exchange with the mirror rank before the split
+ */
+template <typename T>
+void FftRuntime<T>::enterMirror()
+{
+  if (!realInput)
+  {
+    gaspi_printf("Main Computation finished\n");
+    enterOutput();
+    return;
+  }
+
+  const MergeStage & last = stages.back();
+  char * base = (char *) rdma->getRdmaPointer();
+
+  /* X[M] only depends on Z[0], the first element of the master */
+  complex_t * z0 = (complex_t *) (base + rdma->getCalcBufferOffset1());
+  for (unsigned int v = 0; v < batchCount; v++)
+  {
+    nyquist[v] = FftwTraits<T>::real(z0[v]) - FftwTraits<T>::imag(z0[v]);
+  }
+
+  rdma->writeTransfers(mirrorSends);
+  phase = phase_mirror;
+  setWait(mirrorNotifyBase, last.radix + 1, mirrorNotifyCount, true);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftRuntime<T>::splitReal()
+{
+  const MergeStage & last = stages.back();
+  unsigned int lastStage = stages.size() - 1;
+  char * base = (char *) rdma->getRdmaPointer();
+
+  compute->realSplit(last.radix, last.blocklength, last.groupsize,
+                     positionInGroup(lastStage, rank),
+                     (const complex_t *) (base + mirrorOffset),
+                     (const complex_t *) (base + edgeOffset));
+
   gaspi_printf("Main Computation finished\n");
+  enterOutput();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Posts the transfers of pendingOutput: the gather on the master or the
+ * all-to-all into natural order
+ */
+template <typename T>
+void FftRuntime<T>::enterOutput()
+{
+  const MergeStage & last = stages.back();
+  unsigned int lastStage = stages.size() - 1;
+
+  phase = phase_output;
+  if (pendingOutput == output_gathered)
+  {
+    if (rank == master_rank)
+    {
+      rdma->copyCalcBufferToResultBuffer(last.radix, last.blocklength,
+                                         totalVectorLength);
+      unsigned int queues = RdmaManager<T>::getQueueCount();
+      setWait(gatherNotifyBase + queues, (nodecount - 1) * queues,
+              (nodecount - 1) * queues, false);
+    }
+    else
+    {
+      rdma->writeResultToMaster(positionInGroup(lastStage, rank), last.radix,
+                                last.blocklength, totalVectorLength,
+                                gatherNotifyBase + rank * RdmaManager<T>::getQueueCount());
+      setWait(0, 0, 0, true);
+    }
+  }
+  else if (pendingOutput == output_natural)
+  {
+    rdma->writeTransfers(reorderSends);
+    setWait(reorderNotifyBase, last.radix, reorderNotifyCount, true);
+  }
+  else
+  {
+    phase = phase_done;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void FftRuntime<T>::finishOutput()
+{
+  if (pendingOutput == output_gathered && realInput && rank == master_rank)
+  {
+    complex_t * pResult = (complex_t *) ((char *) rdma->getRdmaPointer()
+        + rdma->getInitialOffset1());
+    for (unsigned int v = 0; v < batchCount; v++)
+    {
+      pResult[totalVectorLength * batchCount + v] = nyquist[v];
+    }
+  }
+  if (pendingOutput == output_natural)
+  {
+    reordered = true;
+  }
+  phase = phase_done;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Backward transform of the distributed output of forward(), possibly
+ * modified in place. The stages are undone in reverse order, the signal
+ * ends up in the initial buffers in the input layout of the forward
+ * transform, rank r holds x[r + i * nodecount]. Without normalization
+ * the signal is scaled by its length.
+ */
+template <typename T>
+void FftRuntime<T>::inverse(bool normalize)
+{
+  char * base = (char *) rdma->getRdmaPointer();
+  unsigned long sendBase = rdma->getInitialOffset1();
+  unsigned int lastStage = stages.size() - 1;
+  complex_t * outputs[maxKernelRadix];
+
+  assert(withInverse);
+  assert(!reordered);
+
+  /* the peers may still read their receive buffers of the forward pass */
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+
+  if (realInput)
+  {
+    const MergeStage & last = stages.back();
 
+    rdma->writeTransfers(mirrorSends);
+    rdma->waitOnNotifyRange( mirrorNotifyBase , last.radix + 1 ,
+                             mirrorNotifyCount );
+    rdma->waitOnQueues();
+
+    /* the mirror of X[0] is X[M] */
+    if (rank == master_rank)
+    {
+      for (unsigned int v = 0; v < batchCount; v++)
+      {
+        ((complex_t *) (base + edgeOffset))[v] = nyquist[v];
+      }
+    }
+    compute->realSplit(last.radix, last.blocklength, last.groupsize,
+                       positionInGroup(lastStage, rank),
+                       (const complex_t *) (base + mirrorOffset),
+                       (const complex_t *) (base + edgeOffset), true);
+  }
+
+  for (unsigned int s = lastStage; s > 0; s--)
+  {
+    const MergeStage & stage = stages[s];
+    unsigned int ownGroup = (rank / stage.stride) % stage.radix;
+
+    /* the own block goes back in place, the others into the send buffer */
+    for (unsigned int m = 0; m < stage.radix; m++)
+    {
+      int slot = slotOfGroup(s, m, ownGroup);
+      if (slot < 0)
+        outputs[m] = (complex_t *) (base + stage.inputOffsets[m]);
+      else
+        outputs[m] = (complex_t *) (base + sendBase
+            + slot * stage.blocklength * elementSize);
+    }
+
+    compute->calculateTwiddles(stage.kmin, stage.mergeLength, stage.blocklength);
+    compute->inverseMerge(stage.radix, outputs, stage.blocklength);
+    rdma->writeTransfers(stage.inverseSends);
+
+    gaspi_printf("Wait on inverse stage %d\n", s);
+    rdma->waitOnNotifyRange( stage.inverseNotifyBase , stage.inverseNotifyRange ,
+                             stage.inverseNotifyCount );
+    rdma->waitOnQueues();
+    rdma->writeTransfers(stage.unpacks);
+  }
+
+  compute->calculateInverseFftw();
+  if (normalize)
+  {
+    compute->scaleResult((T) 1 / signalLength);
+  }
+  normalized = normalize;
+
+  gaspi_printf("Inverse Computation finished\n");
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Collects the distributed output of forward() on the master
+ */
+template <typename T>
+void FftRuntime<T>::gatherSpectrum()
+{
+  pendingOutput = output_gathered;
+  enterOutput();
+  progress(true);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * All-to-all of the distributed output of forward() into natural order,
+ * afterwards rank r holds X[r * N / nodecount ...] in its initial buffer.
+ * The initial buffers are free once forward() returned, since every rank
+ * finished its local FFT before the last stage could complete.
+ */
+template <typename T>
+void FftRuntime<T>::reorderSpectrum()
+{
+  pendingOutput = output_natural;
+  enterOutput();
+  progress(true);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Collects the signal of inverse() on the master in natural order
+ */
+template <typename T>
+void FftRuntime<T>::gatherSignal()
+{
   if (rank == 0)
   {
-    rdma->copyCalcBufferToResultBuffer(totalVectorLength);
-    rdma->waitOnNotifies( ((int) log2(nodecount)) + 1 , nodecount - 1 );
+    rdma->waitOnNotifies( gatherNotifyBase + 1 , nodecount - 1 );
+    rdma->sortGatheredSignal(rdma->getBufferLength() * splitCount);
   }
   else
   {
-    rdma->writeResultToMaster(calcReverseBitOrder(rank), totalVectorLength);
-    gaspi_wait( 0 , GASPI_BLOCK );
+    rdma->writeSignalToMaster(rdma->getBufferLength() * splitCount,
+                              gatherNotifyBase + rank);
+    rdma->waitOnQueues();
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Local part of the forward output, element offset holds X[spectrumIndex(offset)],
+ * vector v of a batch at offset * batchCount + v. With real input the
+ * master keeps X[M] in nyquistValue(). After reorderSpectrum() it is the
+ * initial buffer.
+ */
+template <typename T>
+typename FftRuntime<T>::complex_t * FftRuntime<T>::getSpectrum()
+{
+  return (complex_t *) ((char *) rdma->getRdmaPointer()
+      + (reordered ? rdma->getInitialOffset1() : rdma->getCalcBufferOffset1()));
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long FftRuntime<T>::spectrumIndex(unsigned long offset)
+{
+  const MergeStage & last = stages.back();
+  unsigned long position = positionInGroup(stages.size() - 1, rank);
+  unsigned long block    = offset / last.blocklength;
+
+  if (reordered)
+    return rank * last.radix * last.blocklength + offset;
+
+  return block * last.groupsize * last.blocklength
+      + position * last.blocklength + offset % last.blocklength;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+T & FftRuntime<T>::nyquistValue(unsigned int vector)
+{
+  return nyquist[vector];
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Writes the spectrum in natural order to path, called on all ranks after
+ * the forward transform. Every rank writes its own blocks in any output
+ * mode: one block after reorderSpectrum() or the radix blocks of the
+ * last stage, the master also X[M] of real input.
+ */
+template <typename T>
+void FftRuntime<T>::writeSpectrum(const std::string & path, bool sync)
+{
+  const MergeStage & last = stages.back();
+  unsigned long resultLength = realInput ? totalVectorLength + 1
+                                         : totalVectorLength;
+  ResultFile * file = NULL;
+
+  if (rank == master_rank)
+  {
+    ResultHeader header;
+    memcpy(header.magic, "GASPIFFT", sizeof(header.magic));
+    header.version     = 1;
+    header.scalarBytes = sizeof(T);
+    header.length      = resultLength;
+    header.batchCount  = batchCount;
+    header.ordering    = ResultFile::orderingNatural;
+
+    file = new ResultFile(path, true);
+    file->writeHeader(header, resultLength * elementSize);
+  }
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+  if (rank != master_rank)
+  {
+    file = new ResultFile(path, false);
+  }
+
+  /* the calc buffers still hold the blocks of the last stage after the
+     gather, so the master doesn't write the gathered spectrum alone */
+  const char * spectrum = (const char *) getSpectrum();
+  unsigned long blocks    = reordered ? 1 : last.radix;
+  unsigned long blocksize = (totalVectorLength / nodecount / blocks) * elementSize;
+
+  for (unsigned long j = 0; j < blocks; j++)
+  {
+    unsigned long offset = j * blocksize / elementSize;
+    file->write(spectrum + j * blocksize, spectrumIndex(offset) * elementSize,
+                blocksize);
+  }
+
+  if (realInput && rank == master_rank)
+  {
+    complex_t * edge = new complex_t[batchCount];
+    for (unsigned int v = 0; v < batchCount; v++)
+    {
+      edge[v] = nyquist[v];
+    }
+    file->write(edge, totalVectorLength * elementSize, elementSize);
+    delete[] edge;
   }
+
+  file->close(sync);
+  delete file;
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
 }
 
 //------------------------------------------------------------------------------
-void FftRuntime::validateFFT()
+/*
+ * The reference transform is always computed in double precision
+ */
+template <typename T>
+void FftRuntime<T>::validateFFT()
 {
-  fftw_complex * pResult = (fftw_complex *) ((char *) rdma->getRdmaPointer()
+  complex_t * pResult = (complex_t *) ((char *) rdma->getRdmaPointer()
       + rdma->getInitialOffset1());
 
-  fftw_complex * in = (fftw_complex *) fftw_malloc(
-      sizeof(fftw_complex) * totalVectorLength);
+  /* with real input the half spectrum X[0], ..., X[M] is compared */
+  unsigned long resultLength = realInput ? totalVectorLength + 1
+                                         : totalVectorLength;
+  void * in;
+  fftw_plan plan;
   fftw_complex * out = (fftw_complex *) fftw_malloc(
-      sizeof(fftw_complex) * totalVectorLength);
-  fftw_plan plan = fftw_plan_dft_1d(totalVectorLength, in, out, FFTW_FORWARD,
-      FFTW_ESTIMATE);
-  for (unsigned long i = 0; i < totalVectorLength; i++) {
-    in[i] = rdma->generateFakeData(i,totalVectorLength);
+      sizeof(fftw_complex) * resultLength);
+
+  double * samples = NULL;
+  fftw_complex * values = NULL;
+
+  if (realInput) {
+    samples = (double *) fftw_malloc(sizeof(double) * signalLength);
+    plan = fftw_plan_dft_r2c_1d(signalLength, samples, out, FFTW_ESTIMATE);
+    in = samples;
+  } else {
+    values = (fftw_complex *) fftw_malloc(
+        sizeof(fftw_complex) * totalVectorLength);
+    plan = fftw_plan_dft_1d(totalVectorLength, values, out, FFTW_FORWARD,
+        FFTW_ESTIMATE);
+    in = values;
   }
-  fftw_execute(plan);
 
   gaspi_printf("Result of 1d FFT\n");
   double diff = 0.0;
   double max = 0.0;
-  for (unsigned long i = 0; i < totalVectorLength; i++) {
-    double tmp_diff_real = std::abs(creal(out[i]))
-        - std::abs(creal(pResult[i]));
-    double tmp_max_real =
-        std::abs(creal(out[i])) > std::abs(creal(pResult[i])) ?
-            creal(out[i]) : creal(pResult[i]);
+  /* the vectors of a batch are interleaved in the result */
+  for (unsigned int v = 0; v < batchCount; v++) {
+    /* with real input the packed vector holds the samples */
+    rdma->readInputVector(v, totalVectorLength, (fftw_complex *) in);
+    fftw_execute(plan);
 
-    diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
-    max = std::abs(tmp_max_real) > std::abs(max) ? tmp_max_real : max;
+    for (unsigned long i = 0; i < resultLength; i++) {
+      complex_t result = pResult[i * batchCount + v];
+      double tmp_diff_real = std::abs(creal(out[i]))
+          - std::abs(creal(result));
+      double tmp_max_real =
+          std::abs(creal(out[i])) > std::abs(creal(result)) ?
+              creal(out[i]) : creal(result);
 
-    double tmp_diff_imag = std::abs(cimag(out[i]))
-        - std::abs(cimag(pResult[i]));
-    double tmp_max_imag =
-        std::abs(cimag(out[i])) > std::abs(cimag(pResult[i])) ?
-            cimag(out[i]) : cimag(pResult[i]);
+      diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
+      max = std::abs(tmp_max_real) > std::abs(max) ? tmp_max_real : max;
 
-    diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
-    max = std::abs(tmp_max_imag) > std::abs(max) ? tmp_max_imag : max;
+      double tmp_diff_imag = std::abs(cimag(out[i]))
+          - std::abs(cimag(result));
+      double tmp_max_imag =
+          std::abs(cimag(out[i])) > std::abs(cimag(result)) ?
+              cimag(out[i]) : cimag(result);
 
+      diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
+      max = std::abs(tmp_max_imag) > std::abs(max) ? tmp_max_imag : max;
+    }
   }
   std::cout << "Relativer Fehler " <<  (double) (std::abs(diff) / std::abs(max)) << "\n";
   std::cout << "Abweichnung max. " << std::abs(diff) << "\n";
@@ -231,9 +1402,116 @@ void FftRuntime::validateFFT()
 }
 
 //------------------------------------------------------------------------------
-FftRuntime::~FftRuntime()
+/*
+ * Compares the local part of the spectrum without gathering it, called
+ * on every rank. Each rank computes the whole reference.
+ */
+template <typename T>
+void FftRuntime<T>::validateLocalSpectrum()
+{
+  const complex_t * spectrum = getSpectrum();
+  unsigned long localLength = totalVectorLength / nodecount;
+  unsigned long resultLength = realInput ? totalVectorLength + 1
+                                         : totalVectorLength;
+  fftw_complex * out = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * resultLength);
+  fftw_plan plan;
+  void * in;
+
+  if (realInput) {
+    in = fftw_malloc(sizeof(double) * signalLength);
+    plan = fftw_plan_dft_r2c_1d(signalLength, (double *) in, out, FFTW_ESTIMATE);
+  } else {
+    in = fftw_malloc(sizeof(fftw_complex) * totalVectorLength);
+    plan = fftw_plan_dft_1d(totalVectorLength, (fftw_complex *) in, out,
+        FFTW_FORWARD, FFTW_ESTIMATE);
+  }
+
+  double diff = 0.0;
+  double max = 0.0;
+  for (unsigned int v = 0; v < batchCount; v++) {
+    rdma->readInputVector(v, totalVectorLength, (fftw_complex *) in);
+    fftw_execute(plan);
+
+    for (unsigned long i = 0; i <= localLength; i++) {
+      complex_t result;
+      unsigned long k;
+      if (i < localLength) {
+        result = spectrum[i * batchCount + v];
+        k = spectrumIndex(i);
+      } else if (realInput && rank == master_rank) {
+        result = nyquist[v];
+        k = totalVectorLength;
+      } else {
+        break;
+      }
+      double tmp_diff_real = creal(out[k]) - creal(result);
+      double tmp_diff_imag = cimag(out[k]) - cimag(result);
+
+      diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
+      diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
+      max = std::abs(creal(out[k])) > std::abs(max) ? creal(out[k]) : max;
+      max = std::abs(cimag(out[k])) > std::abs(max) ? cimag(out[k]) : max;
+    }
+  }
+  gaspi_printf("Result of 1d FFT on rank %d\n", rank);
+  std::cout << "Rank " << rank << " Relativer Fehler "
+            << (double) (std::abs(diff) / std::abs(max)) << "\n";
+
+  fftw_free(in);
+  fftw_free(out);
+  fftw_destroy_plan(plan);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Compares the signal collected by gatherSignal() with the input
+ */
+template <typename T>
+void FftRuntime<T>::validateRoundTrip()
+{
+  complex_t * pResult = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+  double scale = normalized ? 1.0 : (double) signalLength;
+
+  fftw_complex * values = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * totalVectorLength);
+
+  gaspi_printf("Result of 1d FFT round trip\n");
+  double diff = 0.0;
+  double max = 0.0;
+  for (unsigned int v = 0; v < batchCount; v++) {
+    rdma->readInputVector(v, totalVectorLength, values);
+
+    for (unsigned long i = 0; i < totalVectorLength; i++) {
+      fftw_complex expected = values[i];
+      complex_t result = pResult[i * batchCount + v];
+      double tmp_diff_real = creal(expected) * scale - creal(result);
+      double tmp_diff_imag = cimag(expected) * scale - cimag(result);
+
+      diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
+      diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
+      max = std::abs(creal(expected)) * scale > std::abs(max) ?
+          std::abs(creal(expected)) * scale : max;
+      max = std::abs(cimag(expected)) * scale > std::abs(max) ?
+          std::abs(cimag(expected)) * scale : max;
+    }
+  }
+  fftw_free(values);
+  std::cout << "Relativer Fehler " <<  (double) (std::abs(diff) / std::abs(max)) << "\n";
+  std::cout << "Abweichnung max. " << std::abs(diff) << "\n";
+  std::cout << "max factor " << std::abs(max) << "\n";
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+FftRuntime<T>::~FftRuntime()
 {
-  rdma->destroyInstance();
   delete compute;
-  delete nodes;
+  delete rdma;
 }
+
+//------------------------------------------------------------------------------
+template class FftRuntime<float>;
+template class FftRuntime<double>;
+template class FftRuntime<long double>;
@@ -7,34 +7,235 @@
 
 #ifndef FFT_RUNTIME_HPP_
 #define FFT_RUNTIME_HPP_
-#include <complex.h>
-#include <fftw3.h>
+#include <vector>
+#include <string>
 #include "utils.hpp"
+#include "fftw_traits.hpp"
 #include "fft_computation.hpp"
 #include "rdma_manager.hpp"
 
+/*
+ * Where the spectrum of a forward transform ends up:
+ *   gathered    : in natural order on the master (gatherSpectrum())
+ *   distributed : in the calc buffers in the layout of the last stage
+ *   natural     : rank r holds the block X[r * N / nodecount ...]
+ *                 (reorderSpectrum())
+ */
+typedef enum Output_t {
+  output_gathered, output_distributed, output_natural
+} output_t;
+
+/*
+ * Radices of the merge stages for nodecount ranks: a stage per factor 5
+ * and 3, the power of two part in stages of at most maxRadix. Returns
+ * false if nodecount has another prime factor.
+ */
+bool mergeRadices(unsigned long nodecount, unsigned int maxRadix,
+                  std::vector<unsigned int> & radices);
+
+/*
+ * Distributed 1d transform with complex values of precision T
+ * (float, double or long double). The constructor plans, execute() runs
+ * a transform on new input. start() runs it up to the first missing
+ * notification, test() continues without blocking and the caller can
+ * compute in between, wait() completes it.
+ */
+template <typename T>
 class FftRuntime {
 
 public:
+  typedef typename FftwTraits<T>::complex_t complex_t;
 
-  explicit FftRuntime(unsigned long vectorlength, unsigned int splitCount, gaspi_segment_id_t seg);
+  explicit FftRuntime(unsigned long vectorlength, unsigned int splitCount, gaspi_segment_id_t seg,
+                      const ProcessGroup & group,
+                      unsigned int plannerFlags = FFTW_ESTIMATE,
+                      unsigned int maxRadix = 2,
+                      bool realInput = false,
+                      bool withInverse = false,
+                      unsigned int batchCount = 1,
+                      output_t output = output_gathered,
+                      unsigned int chunkCount = 1);
   ~FftRuntime();
+  void execute(bool normalize = true);
+  void start();
+  bool test();
+  void wait();
   void startRuntime();
+  void forward();
+  void inverse(bool normalize = true);
+  void gatherSpectrum();
+  void gatherSignal();
+  void reorderSpectrum();
+  void writeSpectrum(const std::string & path, bool sync = false);
+  complex_t * getSpectrum();
+  unsigned long spectrumIndex(unsigned long offset);
+  T & nyquistValue(unsigned int vector = 0);
   void distributeVectors();
   void receiveVector();
   void initialOffsets();
   void validateFFT();
-  int getActualMergeNodeID(int expOf2);
-  int calcReverseBitOrder(int number);
-  unsigned long getStartPosInGroup(int exponent);
+  void validateLocalSpectrum();
+  void validateRoundTrip();
+  unsigned long positionInGroup(unsigned int stage, unsigned long node);
+  unsigned long rankInGroup(unsigned int stage, unsigned long group,
+                            unsigned long position);
   double generateFakeData(size_t idx);
 
 private:
-  FftComputation *compute;
-  RdmaManager * rdma;
-  int * nodes;
+  /*
+   * After stage s the ranks form groups of groupsize ranks, the members of
+   * a group are stride ranks apart (group id = rank % stride). Each group
+   * holds the transform of x[group + i * stride] and the rank at position q
+   * owns the radix blocks
+   *   Y[j * mergeLength / radix + q * blocklength + t] , 0 <= t < blocklength
+   * stored as block j of its calc buffer. stages[0] describes the data
+   * after the local FFT.
+   *
+   * The transfers of a stage are split into chunks of chunkLength
+   * elements of a block, chunk c of every slot notifies in its own range
+   * notifyBase + c * notifyRange ..., so chunk c is merged while the later
+   * chunks are still in flight. The sends are ordered by the chunk of the
+   * previous stage they read, sendsReady[c] of them can be written once
+   * chunk c of the previous stage is merged.
+   *
+   * A direct stage has only ranks of the own host in its groups (shared
+   * memory). Blocks which lie in one piece in the calc buffer of a peer
+   * are merged from its mapping in place: the peer only notifies that
+   * the chunk is final (sends of size 0) and after the last chunk every
+   * reader notifies the peer at releaseNotifyBase + its position, the
+   * peer waits on releaseCount of them before it moves on. A direct stage
+   * writes its result into the other calc buffer than the one it reads,
+   * outputOffset is the buffer a stage writes (stages[0]: the local FFT),
+   * the last stage ends in calc buffer 1.
+   */
+  struct MergeStage
+  {
+    unsigned int                             radix;
+    unsigned long                            stride;
+    unsigned long                            groupsize;
+    unsigned long                            blocklength;
+    unsigned long                            mergeLength;
+    unsigned long                            kmin;
+    /* the block of the own sub-group is already local */
+    bool                                     stable;
+    unsigned int                             piecesPerSlot;
+    unsigned int                             chunks;
+    unsigned long                            chunkLength;
+    unsigned long                            recvOffset;
+    gaspi_notification_id_t                  notifyBase;
+    gaspi_notification_id_t                  notifyRange;
+    std::vector<unsigned int>                notifyCounts;
+    std::vector<unsigned long>               inputOffsets;
+    std::vector<unsigned int>                inputNodes;
+    bool                                     direct;
+    unsigned long                            outputOffset;
+    gaspi_notification_id_t                  releaseNotifyBase;
+    unsigned int                             releaseCount;
+    std::vector<typename RdmaManager<T>::TransferEntry> releases;
+    std::vector<typename RdmaManager<T>::TransferEntry> sends;
+    std::vector<unsigned long>               sendsReady;
+    /*
+     * Inverse: the pieces go back along the reversed transfers into the
+     * receive buffers of the stage and are unpacked into the calc buffer
+     */
+    gaspi_notification_id_t                  inverseNotifyBase;
+    gaspi_notification_id_t                  inverseNotifyRange;
+    unsigned int                             inverseNotifyCount;
+    std::vector<typename RdmaManager<T>::TransferEntry> inverseSends;
+    std::vector<typename RdmaManager<T>::TransferEntry> unpacks;
+  };
+
+  /*
+   * Progress of a started transform: the current phase waits for
+   * waitCount notifications of [waitBase, waitBase + waitRange) and with
+   * waitQueues for its own sends, then runs its step, which posts the
+   * next transfers and enters the next phase.
+   */
+  typedef enum Phase_t {
+    phase_done, phase_ready, phase_input, phase_exchange, phase_merge,
+    phase_release, phase_mirror, phase_output
+  } phase_t;
+
+  phase_t phase;
+  unsigned int currentStage;
+  unsigned int currentChunk;
+  output_t pendingOutput;
+  gaspi_notification_id_t waitBase;
+  gaspi_notification_id_t waitRange;
+  unsigned int waitCount;
+  bool waitQueues;
+
+  void beginForward(output_t target);
+  void setWait(gaspi_notification_id_t base, gaspi_notification_id_t range,
+               unsigned int count, bool queues);
+  bool progress(bool block);
+  void enterInput();
+  void scatterInput();
+  void enterMerge();
+  void mergeChunk();
+  void enterRelease();
+  void enterMirror();
+  void splitReal();
+  void enterOutput();
+  void finishOutput();
+
+  void buildSchedule(unsigned int maxRadix);
+  void selectDirectStages();
+  void initialTransfers();
+  void initialMirrorTransfers();
+  void initialReorderTransfers();
+  unsigned long returnOffset(unsigned int stage, unsigned long node,
+                             unsigned long offset);
+  void locateInGroup(unsigned int stage, unsigned long k,
+                     unsigned long & position, unsigned long & offset);
+  int  slotOfGroup(unsigned int stage, unsigned int group,
+                   unsigned int ownGroup);
+
+  FftComputation<T> * compute;
+  RdmaManager<T> * rdma;
+  std::vector<MergeStage> stages;
+  unsigned long recvBytes;
+  /* second calc buffer behind calc buffer 1, 0 without direct stages */
+  unsigned long mergeBufferOffset;
+  gaspi_notification_id_t distributionNotify;
+  gaspi_notification_id_t readyNotify;
+  gaspi_notification_id_t gatherNotifyBase;
+  /*
+   * Real input: the vector is the packed signal of signalLength real
+   * samples. Before the split every rank receives the calc buffer of its
+   * mirror rank and the radix values Z[M-k] of its t = 0 outputs.
+   */
+  bool realInput;
+  unsigned long signalLength;
+  unsigned long mirrorOffset;
+  unsigned long edgeOffset;
+  gaspi_notification_id_t mirrorNotifyBase;
+  unsigned int mirrorNotifyCount;
+  std::vector<typename RdmaManager<T>::TransferEntry> mirrorSends;
+  /* X[M] of every vector of a real transform, kept by the master */
+  std::vector<T> nyquist;
+  bool withInverse;
+  bool normalized;
+  /*
+   * Natural order: block j of the rank at position q of the last stage is
+   * chunk j * nodecount + q of the spectrum, chunk c goes to rank
+   * c / radix at block c % radix of its initial buffer.
+   */
+  gaspi_notification_id_t reorderNotifyBase;
+  unsigned int reorderNotifyCount;
+  std::vector<typename RdmaManager<T>::TransferEntry> reorderSends;
+  bool reordered;
+  output_t output;
+  /*
+   * Batch: batchCount vectors share the schedule, an element of the layout
+   * holds the values of all vectors at one index (elementSize bytes), so
+   * every transfer carries the slices of the whole batch.
+   */
+  unsigned int batchCount;
+  unsigned long elementSize;
+  unsigned int chunkCount;
+  const ProcessGroup & group;
   gaspi_rank_t  rank;
-  int levelCount;
   gaspi_rank_t nodecount;
   gaspi_rank_t master_rank;
   unsigned int splitCount;
@@ -0,0 +1,141 @@
+/*
+ * fftw_traits.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef FFTW_TRAITS_HPP_
+#define FFTW_TRAITS_HPP_
+#include <complex.h>
+#include <fftw3.h>
+
+typedef enum Precision_t {
+  precision_float, precision_double, precision_long
+} precision_t;
+
+/*
+ * Maps the scalar type of a transform onto the matching FFTW library:
+ *   float -> fftwf_ , double -> fftw_ , long double -> fftwl_
+ * A complex value is stored as two interleaved scalars (re, im).
+ * planManyDft plans howmany transforms of length n (or of the rank
+ * dimensional shape n), stride is the distance of two elements and dist
+ * the distance of two vectors.
+ */
+template <typename T> struct FftwTraits;
+
+//------------------------------------------------------------------------------
+template <>
+struct FftwTraits<float>
+{
+  typedef fftwf_complex complex_t;
+  typedef fftwf_plan    plan_t;
+
+  static const char * name() { return "float"; }
+
+  static plan_t planDft1d(int n, complex_t * in, complex_t * out,
+                          int sign, unsigned int flags)
+  { return fftwf_plan_dft_1d(n, in, out, sign, flags); }
+  static plan_t planManyDft(int n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftwf_plan_many_dft(1, &n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static plan_t planManyDft(int rank, const int * n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftwf_plan_many_dft(rank, n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static void   execute(plan_t plan)         { fftwf_execute(plan); }
+  static void   destroyPlan(plan_t plan)     { fftwf_destroy_plan(plan); }
+  static void * allocate(size_t bytes)       { return fftwf_malloc(bytes); }
+  static void   release(void * p)            { fftwf_free(p); }
+  static int    initThreads()                { return fftwf_init_threads(); }
+  static void   planWithNthreads(int n)      { fftwf_plan_with_nthreads(n); }
+  static int    importWisdom(const char * f) { return fftwf_import_wisdom_from_filename(f); }
+  static int    exportWisdom(const char * f) { return fftwf_export_wisdom_to_filename(f); }
+  static complex_t cexp(complex_t z)         { return ::cexpf(z); }
+  static complex_t conj(complex_t z)         { return ::conjf(z); }
+  static float real(complex_t z)            { return ::crealf(z); }
+  static float imag(complex_t z)            { return ::cimagf(z); }
+};
+
+//------------------------------------------------------------------------------
+template <>
+struct FftwTraits<double>
+{
+  typedef fftw_complex complex_t;
+  typedef fftw_plan    plan_t;
+
+  static const char * name() { return "double"; }
+
+  static plan_t planDft1d(int n, complex_t * in, complex_t * out,
+                          int sign, unsigned int flags)
+  { return fftw_plan_dft_1d(n, in, out, sign, flags); }
+  static plan_t planManyDft(int n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftw_plan_many_dft(1, &n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static plan_t planManyDft(int rank, const int * n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftw_plan_many_dft(rank, n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static void   execute(plan_t plan)         { fftw_execute(plan); }
+  static void   destroyPlan(plan_t plan)     { fftw_destroy_plan(plan); }
+  static void * allocate(size_t bytes)       { return fftw_malloc(bytes); }
+  static void   release(void * p)            { fftw_free(p); }
+  static int    initThreads()                { return fftw_init_threads(); }
+  static void   planWithNthreads(int n)      { fftw_plan_with_nthreads(n); }
+  static int    importWisdom(const char * f) { return fftw_import_wisdom_from_filename(f); }
+  static int    exportWisdom(const char * f) { return fftw_export_wisdom_to_filename(f); }
+  static complex_t cexp(complex_t z)         { return ::cexp(z); }
+  static complex_t conj(complex_t z)         { return ::conj(z); }
+  static double real(complex_t z)           { return ::creal(z); }
+  static double imag(complex_t z)           { return ::cimag(z); }
+};
+
+//------------------------------------------------------------------------------
+template <>
+struct FftwTraits<long double>
+{
+  typedef fftwl_complex complex_t;
+  typedef fftwl_plan    plan_t;
+
+  static const char * name() { return "long"; }
+
+  static plan_t planDft1d(int n, complex_t * in, complex_t * out,
+                          int sign, unsigned int flags)
+  { return fftwl_plan_dft_1d(n, in, out, sign, flags); }
+  static plan_t planManyDft(int n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftwl_plan_many_dft(1, &n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static plan_t planManyDft(int rank, const int * n, int howmany,
+                            complex_t * in, int istride, int idist,
+                            complex_t * out, int ostride, int odist,
+                            int sign, unsigned int flags)
+  { return fftwl_plan_many_dft(rank, n, howmany, in, NULL, istride, idist,
+                              out, NULL, ostride, odist, sign, flags); }
+  static void   execute(plan_t plan)         { fftwl_execute(plan); }
+  static void   destroyPlan(plan_t plan)     { fftwl_destroy_plan(plan); }
+  static void * allocate(size_t bytes)       { return fftwl_malloc(bytes); }
+  static void   release(void * p)            { fftwl_free(p); }
+  static int    initThreads()                { return fftwl_init_threads(); }
+  static void   planWithNthreads(int n)      { fftwl_plan_with_nthreads(n); }
+  static int    importWisdom(const char * f) { return fftwl_import_wisdom_from_filename(f); }
+  static int    exportWisdom(const char * f) { return fftwl_export_wisdom_to_filename(f); }
+  static complex_t cexp(complex_t z)         { return ::cexpl(z); }
+  static complex_t conj(complex_t z)         { return ::conjl(z); }
+  static long double real(complex_t z)      { return ::creall(z); }
+  static long double imag(complex_t z)      { return ::cimagl(z); }
+};
+
+#endif /* FFTW_TRAITS_HPP_ */
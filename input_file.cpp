@@ -0,0 +1,134 @@
+/*
+ * input_file.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <complex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "input_file.hpp"
+
+//------------------------------------------------------------------------------
+InputFile::InputFile(const std::string & filePath, input_format_t fileFormat)
+:path( filePath ), format( fileFormat ), window( NULL )
+{
+  struct stat info;
+
+  fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0 || fstat(fd, &info) != 0)
+  {
+    std::cerr << "ERROR # InputFile # can't open " << path << std::endl;
+    exit(2);
+  }
+  fileSize = info.st_size;
+
+  if (posix_memalign((void **) &window, windowAlignment, windowBytes) != 0)
+  {
+    std::cerr << "ERROR # InputFile # no memory for the read window" << std::endl;
+    exit(2);
+  }
+}
+
+//------------------------------------------------------------------------------
+InputFile::~InputFile()
+{
+  free(window);
+  close(fd);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Reads at most bytes of the window at offset, returns the number of
+ * bytes read
+ */
+unsigned long InputFile::readWindow(unsigned long offset, unsigned long bytes)
+{
+  unsigned long size = fileSize - offset < bytes ?
+      fileSize - offset : bytes;
+  unsigned long done = 0;
+
+  while (done < size)
+  {
+    ssize_t ret = pread(fd, window + done, size - done, offset + done);
+    if (ret <= 0)
+    {
+      std::cerr << "ERROR # InputFile # read of " << path << " failed"
+          << std::endl;
+      exit(2);
+    }
+    done += ret;
+  }
+  return done;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The windows start at the aligned offset below the first element and
+ * end at the aligned offset behind the last one, so only the slice and
+ * at most an alignment on both sides is read. Records are 8 or 16 bytes
+ * and never cross a window.
+ */
+template <typename C>
+void InputFile::read(unsigned int vector, unsigned long length, bool packedReal,
+                     unsigned long first, unsigned long count,
+                     C * dest, unsigned long destStride)
+{
+  unsigned long recordSize = (format == format_cfloat
+      || (format == format_real && !packedReal)) ? 8 : 16;
+  unsigned long base = (vector * length + first) * recordSize;
+  unsigned long last = base + count * recordSize;
+
+  if (count == 0)
+    return;
+
+  if (last > fileSize)
+  {
+    std::cerr << "ERROR # InputFile # " << path << " holds less than "
+        << (vector + 1) * length << " elements" << std::endl;
+    exit(2);
+  }
+
+  unsigned long sliceEnd = (last + windowAlignment - 1) / windowAlignment * windowAlignment;
+  unsigned long offset = base / windowAlignment * windowAlignment;
+  unsigned long j = 0;
+  while (j < count)
+  {
+    unsigned long end = offset + readWindow(offset, sliceEnd - offset < windowBytes ?
+                                                    sliceEnd - offset : windowBytes);
+
+    for (; j < count && base + j * recordSize < end; j++)
+    {
+      const char * record = window + (base + j * recordSize - offset);
+      C & value = dest[j * destStride];
+
+      if (format == format_cfloat)
+      {
+        const float * pair = (const float *) record;
+        value = pair[0] + I * pair[1];
+      }
+      else if (recordSize == 16)
+      {
+        const double * pair = (const double *) record;
+        value = pair[0] + I * pair[1];
+      }
+      else
+      {
+        value = *(const double *) record;
+      }
+    }
+    offset = end;
+  }
+}
+
+//------------------------------------------------------------------------------
+template void InputFile::read<float _Complex>(unsigned int, unsigned long, bool,
+    unsigned long, unsigned long, float _Complex *, unsigned long);
+template void InputFile::read<double _Complex>(unsigned int, unsigned long, bool,
+    unsigned long, unsigned long, double _Complex *, unsigned long);
+template void InputFile::read<long double _Complex>(unsigned int, unsigned long, bool,
+    unsigned long, unsigned long, long double _Complex *, unsigned long);
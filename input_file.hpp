@@ -0,0 +1,54 @@
+/*
+ * input_file.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef INPUT_FILE_HPP_
+#define INPUT_FILE_HPP_
+#include <string>
+
+typedef enum InputFormat_t {
+  format_cdouble, format_cfloat, format_real
+} input_format_t;
+
+/*
+ * Binary input of the transform, the vectors of a batch follow each other:
+ *   format_cdouble : interleaved complex double (re, im)
+ *   format_cfloat  : interleaved complex float (re, im)
+ *   format_real    : real double samples, with packed real input the
+ *                    samples 2k and 2k+1 form element k, otherwise the
+ *                    imaginary part is 0
+ * Every rank reads its own contiguous slice with pread of large aligned
+ * windows, so the file has to be visible on all nodes.
+ */
+class InputFile {
+
+public:
+  InputFile(const std::string & path, input_format_t format);
+  ~InputFile();
+
+  /*
+   * Elements first ... first + count - 1 of vector of a batch of vectors
+   * with length elements into dest[j * destStride]
+   */
+  template <typename C>
+  void read(unsigned int vector, unsigned long length, bool packedReal,
+            unsigned long first, unsigned long count,
+            C * dest, unsigned long destStride);
+
+private:
+  static const unsigned long windowAlignment = 4096;
+  static const unsigned long windowBytes = 4194304;
+
+  std::string    path;
+  input_format_t format;
+  int            fd;
+  unsigned long  fileSize;
+  char *         window;
+
+  unsigned long  readWindow(unsigned long offset, unsigned long bytes);
+};
+
+#endif /* INPUT_FILE_HPP_ */
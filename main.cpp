@@ -8,44 +8,337 @@
 #include <assert.h>
 #include "utils.hpp"
 #include "fft_runtime.hpp"
+#include "fft_nd_runtime.hpp"
+#include "six_step_runtime.hpp"
+#include "twiddle_cache.hpp"
+#include "fftw_traits.hpp"
+#include "fft_kernels.hpp"
 #include <sstream>
+#include <string>
+#include <vector>
 #include <sys/time.h>
 
 
-#define FFTW_COMPLEX 16
-unsigned int cycle = 1;
+struct RunOptions
+{
+  bool            validation;
+  unsigned long   length;
+  unsigned int    cycles;
+  twiddle_mode_t  twiddleMode;
+  unsigned int    plannerFlags;
+  std::string     wisdomPrefix;
+  int             threads;
+  unsigned int    maxRadix;
+  precision_t     precision;
+  bool            realInput;
+  bool            roundTrip;
+  bool            normalize;
+  unsigned int    batch;
+  unsigned int    dimensionCount;
+  unsigned long   dims[3];
+  decomposition_t decomposition;
+  engine_t        engine;
+  output_t        output;
+  unsigned int    chunks;
+  unsigned int    queues;
+  unsigned int    groupSize;
+  unsigned int    overlap;
+  bool            sharedMemory;
+  std::string     inputPath;
+  input_format_t  inputFormat;
+  std::string     resultPath;
+  bool            syncResult;
+};
+//--------------------------------------------------------------------------------------------
+unsigned long complexSize( precision_t precision )
+{
+  if( precision == precision_float )
+    return sizeof(fftwf_complex);
+  if( precision == precision_long )
+    return sizeof(fftwl_complex);
+  return sizeof(fftw_complex);
+}
 //--------------------------------------------------------------------------------------------
-unsigned long calcMemoryReservation(unsigned long vectorlength, gaspi_rank_t rankcount)
+bool parseDims( const std::string & value , RunOptions & options )
 {
-    unsigned long PartnerCount = log2( rankcount );
+  std::istringstream in( value );
+  unsigned int count = 0;
+  long dim = 0;
+  char sep = 'x';
 
-    unsigned long memPerBuffer = ((vectorlength / (unsigned long) rankcount) / 2)
-                                 * FFTW_COMPLEX;
+  options.dims[2] = 1;
+  while( count < 3 && sep == 'x' && ( in >> dim ) && dim > 0 )
+  {
+    options.dims[count++] = dim;
+    sep = 0;
+    in >> sep;
+  }
+  options.dimensionCount = count;
+  return ( count >= 2 ) && in.eof();
+}
 
-    unsigned long resultMem = vectorlength * FFTW_COMPLEX;
+//--------------------------------------------------------------------------------------------
+bool parseOption( const char * arg , RunOptions & options )
+{
+  std::string option( arg );
 
-    unsigned long exponent = log2( resultMem + memPerBuffer * 2
-     + (PartnerCount * (memPerBuffer + sizeof(int))) + sizeof(int)) + 1;
+  if( option == "v" )
+  {
+    options.validation = true;
+    return true;
+  }
 
-    return (unsigned long) 1 << exponent;
-}
+  std::string::size_type sep = option.find( '=' );
+  if( sep == std::string::npos )
+  {
+    return false;
+  }
+  std::string key   = option.substr( 0 , sep );
+  std::string value = option.substr( sep + 1 );
 
+  if( key == "twiddles" )
+  {
+    if( value == "cached" )
+      options.twiddleMode = twiddles_cached;
+    else if( value == "onthefly" )
+      options.twiddleMode = twiddles_on_the_fly;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "planner" )
+  {
+    if( value == "estimate" )
+      options.plannerFlags = FFTW_ESTIMATE;
+    else if( value == "measure" )
+      options.plannerFlags = FFTW_MEASURE;
+    else if( value == "patient" )
+      options.plannerFlags = FFTW_PATIENT;
+    else if( value == "exhaustive" )
+      options.plannerFlags = FFTW_EXHAUSTIVE;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "wisdom" )
+  {
+    options.wisdomPrefix = value;
+    return !value.empty();
+  }
+  else if( key == "file" )
+  {
+    options.inputPath = value;
+    return !value.empty();
+  }
+  else if( key == "format" )
+  {
+    if( value == "cdouble" )
+      options.inputFormat = format_cdouble;
+    else if( value == "cfloat" )
+      options.inputFormat = format_cfloat;
+    else if( value == "real" )
+      options.inputFormat = format_real;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "result" )
+  {
+    options.resultPath = value;
+    return !value.empty();
+  }
+  else if( key == "sync" )
+  {
+    if( value == "yes" )
+      options.syncResult = true;
+    else if( value == "no" )
+      options.syncResult = false;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "threads" )
+  {
+    options.threads = std::atoi( value.c_str() );
+    return options.threads > 0;
+  }
+  else if( key == "radix" )
+  {
+    options.maxRadix = std::atoi( value.c_str() );
+    return ( options.maxRadix == 2 ) || ( options.maxRadix == 4 )
+           || ( options.maxRadix == 8 );
+  }
+  else if( key == "precision" )
+  {
+    if( value == "float" )
+      options.precision = precision_float;
+    else if( value == "double" )
+      options.precision = precision_double;
+    else if( value == "long" )
+      options.precision = precision_long;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "input" )
+  {
+    if( value == "complex" )
+      options.realInput = false;
+    else if( value == "real" )
+      options.realInput = true;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "transform" )
+  {
+    if( value == "forward" )
+      options.roundTrip = false;
+    else if( value == "roundtrip" )
+      options.roundTrip = true;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "normalize" )
+  {
+    if( value == "yes" )
+      options.normalize = true;
+    else if( value == "no" )
+      options.normalize = false;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "batch" )
+  {
+    int batch = std::atoi( value.c_str() );
+    if( batch <= 0 )
+      return false;
+    options.batch = batch;
+    return true;
+  }
+  else if( key == "dims" )
+  {
+    return parseDims( value , options );
+  }
+  else if( key == "decomposition" )
+  {
+    if( value == "slab" )
+      options.decomposition = decomposition_slab;
+    else if( value == "pencil" )
+      options.decomposition = decomposition_pencil;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "output" )
+  {
+    if( value == "gathered" )
+      options.output = output_gathered;
+    else if( value == "distributed" )
+      options.output = output_distributed;
+    else if( value == "natural" )
+      options.output = output_natural;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "engine" )
+  {
+    if( value == "merge" )
+      options.engine = engine_merge;
+    else if( value == "sixstep" )
+      options.engine = engine_sixstep;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "chunks" )
+  {
+    int chunks = std::atoi( value.c_str() );
+    if( chunks <= 0 )
+      return false;
+    options.chunks = chunks;
+    return true;
+  }
+  else if( key == "queues" )
+  {
+    int queues = std::atoi( value.c_str() );
+    if( queues <= 0 )
+      return false;
+    options.queues = queues;
+    return true;
+  }
+  else if( key == "shm" )
+  {
+    if( value == "yes" )
+      options.sharedMemory = true;
+    else if( value == "no" )
+      options.sharedMemory = false;
+    else
+      return false;
+    return true;
+  }
+  else if( key == "overlap" )
+  {
+    int overlap = std::atoi( value.c_str() );
+    if( overlap <= 0 )
+      return false;
+    options.overlap = overlap;
+    return true;
+  }
+  else if( key == "group" )
+  {
+    int groupSize = std::atoi( value.c_str() );
+    if( groupSize <= 0 )
+      return false;
+    options.groupSize = groupSize;
+    return true;
+  }
+  else if( key == "cycles" )
+  {
+    int cycles = std::atoi( value.c_str() );
+    if( cycles <= 0 )
+      return false;
+    options.cycles = cycles;
+    return true;
+  }
+  return false;
+}
 //--------------------------------------------------------------------------------------------
-bool checkArguments( int argc ,char **argv, bool & val , unsigned long & length )
+bool checkArguments( int argc ,char **argv, RunOptions & options )
 {
-  val = false;
+  options.validation  = false;
+  options.cycles      = 1;
+  options.twiddleMode = twiddles_cached;
+  options.plannerFlags = FFTW_ESTIMATE;
+  options.threads     = 1;
+  options.maxRadix    = 2;
+  options.precision   = precision_double;
+  options.realInput   = false;
+  options.roundTrip   = false;
+  options.normalize   = true;
+  options.batch       = 1;
+  options.dimensionCount = 1;
+  options.decomposition  = decomposition_slab;
+  options.engine         = engine_merge;
+  options.output         = output_gathered;
+  options.chunks         = 1;
+  options.queues         = 1;
+  options.overlap        = 1;
+  options.groupSize      = 0;
+  options.sharedMemory   = false;
+  options.inputFormat    = format_cdouble;
+  options.syncResult     = false;
   if(argc < 3)
   {
     std::cout << "Not enough arguments given\n";
     return false;
   } 
-  else if( argc == 4 ) 
+  for( int arg = 3 ; arg < argc ; arg++ )
   {
-    if(argv[3][0] == 'v')
-    {
-      val = true;
-    }
-    else
+    if( !parseOption( argv[arg] , options ) )
     {
       std::cout << "Wrong Mode given\n";
       return false;
@@ -66,7 +359,7 @@ bool checkArguments( int argc ,char **argv, bool & val , unsigned long & length
   } 
   else if(unit =='U')
   {
-    length = mem_val;
+    options.length = mem_val;
     return true;
   } 
   else
@@ -74,14 +367,198 @@ bool checkArguments( int argc ,char **argv, bool & val , unsigned long & length
     std::cout << "Wrong Unit given\n";
     return false;
   }
-  length = (multiplicator * mem_val) / 16;
+  options.length = (multiplicator * mem_val) / complexSize( options.precision );
+  if( options.realInput )
+  {
+    options.length *= 2;
+  }
   return true;
 }
 //--------------------------------------------------------------------------------------------
+/* the other engines have no options of their own for execute() */
+template <typename Runtime>
+void executeTransform( Runtime & runtime , const RunOptions & /* options */ )
+{
+  runtime.execute();
+}
+//--------------------------------------------------------------------------------------------
+template <typename T>
+void executeTransform( FftRuntime<T> & f2 , const RunOptions & options )
+{
+  f2.execute( options.normalize );
+}
+//--------------------------------------------------------------------------------------------
+template <typename Runtime>
+void finishTransform( Runtime & runtime , const RunOptions & options , gaspi_rank_t rank )
+{
+  if( rank == 0  && options.validation )
+    runtime.validateFFT();
+}
+//--------------------------------------------------------------------------------------------
+template <typename T>
+void finishTransform( FftRuntime<T> & f2 , const RunOptions & options , gaspi_rank_t rank )
+{
+  if( !options.resultPath.empty() )
+    f2.writeSpectrum( options.resultPath , options.syncResult );
+
+  if( options.validation && !options.roundTrip
+      && options.output != output_gathered )
+  {
+    f2.validateLocalSpectrum();
+  }
+  else if( rank == 0  && options.validation )
+  {
+    if( options.roundTrip )
+      f2.validateRoundTrip();
+    else
+      f2.validateFFT();
+  }
+}
+//--------------------------------------------------------------------------------------------
+template <typename Runtime>
+void executeTransforms( const std::vector<Runtime *> & runtimes , const RunOptions & options )
+{
+  for( unsigned int i = 0 ; i < runtimes.size() ; i++ )
+    executeTransform( *runtimes[i] , options );
+}
+//--------------------------------------------------------------------------------------------
+/*
+ * Several merge runtimes start their transforms and complete them through
+ * test(), so the exchanges of the transforms are in flight at the same time
+ */
+template <typename T>
+void executeTransforms( const std::vector<FftRuntime<T> *> & runtimes ,
+                        const RunOptions & options )
+{
+  if( runtimes.size() == 1 )
+  {
+    executeTransform( *runtimes[0] , options );
+    return;
+  }
+
+  for( unsigned int i = 0 ; i < runtimes.size() ; i++ )
+    runtimes[i]->start();
+
+  unsigned int pending = runtimes.size();
+  std::vector<bool> done( runtimes.size() , false );
+  while( pending > 0 )
+  {
+    for( unsigned int i = 0 ; i < runtimes.size() ; i++ )
+    {
+      if( !done[i] && runtimes[i]->test() )
+      {
+        done[i] = true;
+        pending--;
+      }
+    }
+  }
+}
+//--------------------------------------------------------------------------------------------
+/*
+ * The runtimes are planned once, every cycle only executes them on new
+ * input. The groups run their cycles independently of each other.
+ */
+template <typename Runtime>
+void runCycles( const std::vector<Runtime *> & runtimes , const RunOptions & options ,
+                const ProcessGroup & group )
+{
+  gaspi_rank_t rank = group.getRank();
+  struct timeval startTV_excl, endTV_excl;
+
+  for( unsigned int cycle = options.cycles ; cycle > 0 ; cycle-- )
+  {
+    if( rank == 0 )
+      gettimeofday( &startTV_excl, 0 );
+
+    executeTransforms( runtimes , options );
+
+    gaspi_printf("All done\n");
+
+    for( unsigned int i = 0 ; i < runtimes.size() ; i++ )
+      finishTransform( *runtimes[i] , options , rank );
+
+    gaspi_barrier( group.getGroup() , GASPI_BLOCK );
+    if( rank == 0 )
+    {
+      gettimeofday( &endTV_excl, 0 );
+      gaspi_printf("excl. execution time in secs  : %lu\n",endTV_excl.tv_sec  - startTV_excl.tv_sec);
+      gaspi_printf("excl. execution time in usecs : %lu\n",endTV_excl.tv_usec - startTV_excl.tv_usec);
+    }
+  }
+}
+//--------------------------------------------------------------------------------------------
+template <typename T>
+void runTransforms( const RunOptions & options , unsigned long initialLength,
+                    gaspi_segment_id_t used_segment , gaspi_rank_t rank )
+{
+  TwiddleCache<T>::getInstance()->setMode( options.twiddleMode );
+  FftComputation<T>::setThreadCount( options.threads );
+  RdmaManager<T>::setQueueCount( options.queues );
+  RdmaManager<T>::setSharedMemory( options.sharedMemory );
+  if( !options.inputPath.empty() )
+    RdmaManager<T>::setInputFile( options.inputPath , options.inputFormat );
+
+  if( !options.wisdomPrefix.empty() )
+  {
+    if( !FftComputation<T>::importWisdom( options.wisdomPrefix ) && rank == 0 )
+    {
+      gaspi_printf("no wisdom found for %s\n",
+                   FftComputation<T>::wisdomFileName( options.wisdomPrefix ).c_str());
+    }
+  }
+
+  if( rank == 0 )
+  {
+    gaspi_printf("radix-2 kernel                : %s\n", radix2KernelName<T>());
+  }
+
+  ProcessGroup group( options.groupSize );
+
+  if( options.dimensionCount > 1 )
+  {
+    FftNdRuntime<T> fnd(options.dims, options.decomposition, used_segment,
+                        group, options.plannerFlags);
+    runCycles( std::vector<FftNdRuntime<T> *>( 1 , &fnd ) , options , group );
+  }
+  else if( options.engine == engine_sixstep )
+  {
+    SixStepRuntime<T> fss(initialLength, used_segment, group,
+                          options.plannerFlags);
+    runCycles( std::vector<SixStepRuntime<T> *>( 1 , &fss ) , options , group );
+  }
+  else
+  {
+    /* with overlap= one runtime per segment from used_segment on */
+    std::vector<FftRuntime<T> *> runtimes;
+    for( unsigned int i = 0 ; i < options.overlap ; i++ )
+    {
+      runtimes.push_back( new FftRuntime<T>(initialLength, 2, used_segment + i, group,
+                                            options.plannerFlags, options.maxRadix,
+                                            options.realInput, options.roundTrip,
+                                            options.batch, options.output,
+                                            options.chunks) );
+    }
+    runCycles( runtimes , options , group );
+    for( unsigned int i = 0 ; i < runtimes.size() ; i++ )
+      delete runtimes[i];
+  }
+  gaspi_barrier( GASPI_GROUP_ALL , GASPI_BLOCK );
+  if( rank == 0 )
+  {
+    gaspi_printf("twiddle memory in bytes       : %lu\n",
+                 TwiddleCache<T>::getInstance()->getMemoryFootprint());
+  }
+  TwiddleCache<T>::getInstance()->destroyInstance();
+
+  if( !options.wisdomPrefix.empty() )
+  {
+    FftComputation<T>::exportWisdom( options.wisdomPrefix );
+  }
+}
+//--------------------------------------------------------------------------------------------
 int main(int argc, char ** argv)
 {
-  bool               validation   = false;
-  unsigned long      masterLength = 0;
+  RunOptions         options;
 
   gaspi_segment_id_t used_segment = 3;
   gaspi_segment_id_t coll_segment = 1;
@@ -89,15 +566,54 @@ int main(int argc, char ** argv)
   gaspi_rank_t       rank;
   gaspi_rank_t       rankcount;
 
-  if ( !checkArguments(argc,argv,validation,masterLength) ) 
+  if ( !checkArguments(argc,argv,options) ) 
   {
     std::cout << "Not enough arguments" << std::endl;
     std::cout << "How to use :" << std::endl;
-    std::cout << "./gpi_run.sh -n 16 ./bin/main <size> <memory unit> [ v ]\n";
-    std::cout << "memory unit :                        G...Gigabyte\n";
+    std::cout << "./gpi_run.sh -n 16 ./bin/main <size> <memory unit> [ options ]\n";
+    std::cout << "memory unit :                        G...Gigabyte of complex values\n";
     std::cout << "                                     M...Megabyte\n";
+    std::cout << "                                     U...number of elements\n";
     std::cout << "Options:\n";
     std::cout << "v                    enable the correctness check\n";
+    std::cout << "cycles=<n>           number of transforms (default 1)\n";
+    std::cout << "twiddles=<mode>      cached (default) | onthefly\n";
+    std::cout << "planner=<rigor>      estimate (default) | measure | patient | exhaustive\n";
+    std::cout << "wisdom=<prefix>      load/store FFTW wisdom in <prefix>.<hostname>\n";
+    std::cout << "threads=<n>          threads per rank (needs an OpenMP build)\n";
+    std::cout << "radix=<r>            radix of the distributed merge stages 2 (default) | 4 | 8,\n";
+    std::cout << "                     factors 3 and 5 of the rank count add radix-3/5 stages\n";
+    std::cout << "precision=<p>        float | double (default) | long\n";
+    std::cout << "input=<type>         complex (default) | real, real input yields the\n";
+    std::cout << "                     half spectrum X[0..size/2] of size real samples\n";
+    std::cout << "transform=<t>        forward (default) | roundtrip, roundtrip runs the\n";
+    std::cout << "                     inverse on the distributed spectrum and checks the signal\n";
+    std::cout << "normalize=<n>        yes (default) | no, scale the inverse by 1/size\n";
+    std::cout << "batch=<b>            transform b vectors of the given size at once (default 1)\n";
+    std::cout << "dims=<x>x<y>[x<z>]   2d/3d transform of the given shape, replaces the size\n";
+    std::cout << "decomposition=<d>    slab (default) | pencil (3d only) for dims\n";
+    std::cout << "output=<o>           gathered (default) | distributed | natural, where the\n";
+    std::cout << "                     spectrum stays: on rank 0, in the layout of the last\n";
+    std::cout << "                     merge stage or as contiguous block per rank (merge engine)\n";
+    std::cout << "chunks=<n>           split every merge stage into n chunks, chunk c is merged\n";
+    std::cout << "                     while the later ones are in flight (default 1)\n";
+    std::cout << "queues=<n>           stripe the transfers over n GASPI queues (default 1), the\n";
+    std::cout << "                     merge stages get at least n chunks\n";
+    std::cout << "shm=<s>              no (default) | yes, ranks on the same host copy through\n";
+    std::cout << "                     shared memory instead of RDMA\n";
+    std::cout << "overlap=<n>          run n transforms at once through start()/test(), each\n";
+    std::cout << "                     on its own segment (merge engine, forward only)\n";
+    std::cout << "group=<n>            split the ranks into groups of n consecutive ranks, every\n";
+    std::cout << "                     group runs its own transforms (default all ranks)\n";
+    std::cout << "file=<path>          every rank reads its part of the input from the binary\n";
+    std::cout << "                     file instead of the generated signal (1d only)\n";
+    std::cout << "format=<f>           cdouble (default) | cfloat | real, layout of file=,\n";
+    std::cout << "                     the vectors of a batch follow each other\n";
+    std::cout << "result=<path>        every rank writes its part of the spectrum in natural\n";
+    std::cout << "                     order to the binary file (merge engine, forward only)\n";
+    std::cout << "sync=<s>             no (default) | yes, fsync the result file\n";
+    std::cout << "engine=<e>           merge (default) | sixstep, sixstep transforms complex\n";
+    std::cout << "                     input with one all-to-all instead of the merge stages\n";
     std::cout << "Example one gigabyte with correctness check:\n";
     std::cout << "./gpi_run.sh -n 16 ./bin/main 1 G v\n\n";
     std::cout << "Example eight megabyte without correctness check:\n";
@@ -116,7 +632,7 @@ int main(int argc, char ** argv)
   gaspi_proc_num( &rankcount );
   gaspi_proc_rank( &rank );
 
-  struct timeval startTV_incl, endTV_incl, startTV_excl, endTV_excl;
+  struct timeval startTV_incl, endTV_incl;
 
   if( rank == 0 )
   {
@@ -142,7 +658,7 @@ int main(int argc, char ** argv)
 
   if(rank == 0 )
   {
-    *( (unsigned long *) pRdma) = masterLength;
+    *( (unsigned long *) pRdma) = options.length;
   }
 
   gaspi_bcast_binominal( coll_segment, 0UL, sizeof(unsigned long), 0 );
@@ -151,44 +667,142 @@ int main(int argc, char ** argv)
 
   gaspi_segment_delete( coll_segment );
 
-  gaspi_size_t seg_size = calcMemoryReservation( initialLength, rankcount );
+  /* a transform runs on the ranks of one group */
+  if( options.groupSize == 0 )
+    options.groupSize = rankcount;
 
-  ret = gaspi_segment_create( used_segment,
-                              seg_size,
-                              GASPI_GROUP_ALL,
-                              GASPI_BLOCK,
-                              GASPI_MEM_INITIALIZED );
-  if( ret != GASPI_SUCCESS )
+  if( rankcount % options.groupSize != 0 )
   {
-    gaspi_printf("gaspi_segment_create for used segment failed\n");
-    return ret;
+    if( rank == 0 )
+      std::cerr << "group= has to divide the " << rankcount << " ranks" << std::endl;
+    gaspi_proc_term( GASPI_BLOCK );
+    return -1;
   }
-  while( cycle > 0 )
+  if( !options.resultPath.empty() && options.groupSize != rankcount )
   {
-      if( rank == 0 )
-        gettimeofday( &startTV_excl, 0 );
+    if( rank == 0 )
+      std::cerr << "result= needs one group of all ranks" << std::endl;
+    gaspi_proc_term( GASPI_BLOCK );
+    return -1;
+  }
 
-      FftRuntime f2(initialLength, 2, used_segment);
-      f2.startRuntime();
+  if( options.output != output_gathered
+      && ( options.dimensionCount > 1 || options.engine != engine_merge
+           || options.roundTrip ) )
+  {
+    if( rank == 0 )
+      std::cerr << "output= only applies to the forward transform of the merge engine"
+                << std::endl;
+    gaspi_proc_term( GASPI_BLOCK );
+    return -1;
+  }
 
-      gaspi_printf("All done\n");
+  if( options.overlap > 1
+      && ( options.dimensionCount > 1 || options.engine != engine_merge
+           || options.roundTrip || !options.resultPath.empty() ) )
+  {
+    if( rank == 0 )
+      std::cerr << "overlap= only applies to the forward transform of the merge engine"
+                << std::endl;
+    gaspi_proc_term( GASPI_BLOCK );
+    return -1;
+  }
+
+  if( !options.resultPath.empty()
+      && ( options.dimensionCount > 1 || options.engine != engine_merge
+           || options.roundTrip ) )
+  {
+    if( rank == 0 )
+      std::cerr << "result= only applies to the forward transform of the merge engine"
+                << std::endl;
+    gaspi_proc_term( GASPI_BLOCK );
+    return -1;
+  }
 
-     if( rank == 0  && validation )
-        f2.validateFFT();
+  if( options.dimensionCount > 1 )
+  {
+    NdDecomposition decomposition( options.dims , options.decomposition ,
+                                   options.groupSize );
 
-      gaspi_barrier( GASPI_GROUP_ALL , GASPI_BLOCK );
+    if( options.realInput || options.roundTrip || options.batch > 1
+        || !options.inputPath.empty() )
+    {
       if( rank == 0 )
-      {
-        gettimeofday( &endTV_excl, 0 );
-        gaspi_printf("excl. execution time in secs  : %lu\n",endTV_excl.tv_sec  - startTV_excl.tv_sec);
-        gaspi_printf("excl. execution time in usecs : %lu\n",endTV_excl.tv_usec - startTV_excl.tv_usec);
-      }
-      cycle--;
+        std::cerr << "dims= only supports the forward transform of generated complex input"
+                  << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
+    if( !decomposition.isValid() )
+    {
+      if( rank == 0 )
+        std::cerr << "The dimensions don't fit the " << decomposition.getRows()
+                  << " x " << decomposition.getColumns() << " process grid"
+                  << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
   }
-  if( gaspi_segment_delete( used_segment ) != GASPI_SUCCESS )
+  else if( options.engine == engine_sixstep )
   {
-    gaspi_printf("Segment-deletion failed\n");
+    if( options.realInput || options.roundTrip || options.batch > 1 )
+    {
+      if( rank == 0 )
+        std::cerr << "engine=sixstep only supports the forward transform of complex input"
+                  << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
+    if( sixStepColumns( initialLength , options.groupSize ) == 0 )
+    {
+      if( rank == 0 )
+        std::cerr << "The vector length has to be a multiple of "
+                  << (unsigned long) options.groupSize * options.groupSize << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
   }
+  else
+  {
+    std::vector<unsigned int> radices;
+
+    if( !mergeRadices( options.groupSize , options.maxRadix , radices ) )
+    {
+      if( rank == 0 )
+        std::cerr << "The number of ranks has to be a product of 2, 3 and 5"
+                  << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
+
+    /* every stage splits the local vector into radix blocks */
+    unsigned long blockMultiple = 1;
+    for( unsigned int i = 0; i < radices.size(); i++ )
+    {
+      while( blockMultiple % radices[i] != 0 )
+        blockMultiple *= ( radices[i] % 2 == 0 ) ? 2 : radices[i];
+    }
+    unsigned long granularity = (unsigned long) options.groupSize * blockMultiple
+                                * ( options.realInput ? 2 : 1 );
+
+    if( initialLength % granularity != 0 )
+    {
+      if( rank == 0 )
+        std::cerr << "The vector length has to be a multiple of "
+                  << granularity << std::endl;
+      gaspi_proc_term( GASPI_BLOCK );
+      return -1;
+    }
+  }
+
+  /* the transforms create the segment with the exact size of their layout */
+  if( options.precision == precision_float )
+    runTransforms<float>( options, initialLength, used_segment, rank );
+  else if( options.precision == precision_long )
+    runTransforms<long double>( options, initialLength, used_segment, rank );
+  else
+    runTransforms<double>( options, initialLength, used_segment, rank );
+
   if( rank == 0 )
   {
     gettimeofday(&endTV_incl, NULL);
@@ -0,0 +1,97 @@
+/*
+ * process_group.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <cstdlib>
+#include "process_group.hpp"
+
+//------------------------------------------------------------------------------
+ProcessGroup::ProcessGroup()
+:group( GASPI_GROUP_ALL ), first( 0 )
+{
+  gaspi_proc_rank( &rank );
+  gaspi_proc_num( &rankcount );
+  size = rankcount;
+}
+
+//------------------------------------------------------------------------------
+ProcessGroup::ProcessGroup(gaspi_rank_t groupSize)
+:group( GASPI_GROUP_ALL ), size( groupSize )
+{
+  gaspi_rank_t me;
+  gaspi_proc_rank( &me );
+  gaspi_proc_num( &rankcount );
+
+  if (size == 0 || rankcount % size != 0)
+  {
+    std::cerr << "ERROR # ProcessGroup # " << size << " doesn't divide the "
+        << rankcount << " ranks" << std::endl;
+    exit(2);
+  }
+  first = me - me % size;
+  rank  = me % size;
+
+  if (size == rankcount)
+    return;
+
+  if (gaspi_group_create( &group ) != GASPI_SUCCESS)
+  {
+    std::cerr << "ERROR # ProcessGroup # no group left" << std::endl;
+    exit(2);
+  }
+  for (gaspi_rank_t r = 0; r < size; r++)
+    gaspi_group_add( group, first + r );
+
+  if (gaspi_group_commit( group, GASPI_BLOCK ) != GASPI_SUCCESS)
+  {
+    std::cerr << "ERROR # ProcessGroup # commit of group " << getIndex()
+        << " failed" << std::endl;
+    exit(2);
+  }
+}
+
+//------------------------------------------------------------------------------
+ProcessGroup::~ProcessGroup()
+{
+  if (group != GASPI_GROUP_ALL)
+    gaspi_group_delete( group );
+}
+
+//------------------------------------------------------------------------------
+gaspi_group_t ProcessGroup::getGroup() const
+{
+  return group;
+}
+
+//------------------------------------------------------------------------------
+gaspi_rank_t ProcessGroup::getRank() const
+{
+  return rank;
+}
+
+//------------------------------------------------------------------------------
+gaspi_rank_t ProcessGroup::getSize() const
+{
+  return size;
+}
+
+//------------------------------------------------------------------------------
+gaspi_rank_t ProcessGroup::getGlobalRank(gaspi_rank_t groupRank) const
+{
+  return first + groupRank;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ProcessGroup::getIndex() const
+{
+  return first / size;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ProcessGroup::getGroupCount() const
+{
+  return rankcount / size;
+}
@@ -0,0 +1,45 @@
+/*
+ * process_group.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef PROCESS_GROUP_HPP_
+#define PROCESS_GROUP_HPP_
+#include <GASPI.h>
+
+/*
+ * Ranks which run their own transforms. The job is split into groups of
+ * size consecutive ranks, rank r belongs to group r / size and has the
+ * group rank r % size. A runtime only talks to the ranks of its group,
+ * addresses them by their group rank and synchronizes with the group.
+ */
+class ProcessGroup {
+
+public:
+  /* all ranks of the job */
+  ProcessGroup();
+  /* collective, size has to divide the number of ranks */
+  explicit ProcessGroup(gaspi_rank_t size);
+  ~ProcessGroup();
+
+  gaspi_group_t getGroup() const;
+  gaspi_rank_t  getRank() const;
+  gaspi_rank_t  getSize() const;
+  gaspi_rank_t  getGlobalRank(gaspi_rank_t groupRank) const;
+  unsigned int  getIndex() const;
+  unsigned int  getGroupCount() const;
+
+private:
+  gaspi_group_t group;
+  gaspi_rank_t  first;
+  gaspi_rank_t  rank;
+  gaspi_rank_t  size;
+  gaspi_rank_t  rankcount;
+
+  ProcessGroup(const ProcessGroup &);
+  ProcessGroup & operator=(const ProcessGroup &);
+};
+
+#endif /* PROCESS_GROUP_HPP_ */
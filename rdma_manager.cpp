@@ -9,168 +9,371 @@
 #include <assert.h>
 #include <cstring>
 #include <cmath>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "rdma_manager.hpp"
 
-RdmaManager * RdmaManager::singleton = NULL;
+template <typename T>
+unsigned int RdmaManager<T>::queueCount = 1;
 
-RdmaManager * RdmaManager::getInstance()
-{
-  if (singleton == NULL) 
-  {
-    singleton = new RdmaManager();
-    assert(singleton);
-  }
+template <typename T>
+InputFile * RdmaManager<T>::inputFile = NULL;
 
-  return singleton;
-}
-//------------------------------------------------------------------------------
-void RdmaManager::initial( gaspi_segment_id_t seg )
+template <typename T>
+bool RdmaManager<T>::sharedMemory = false;
+
+template <typename T>
+RdmaManager<T>::RdmaManager( gaspi_segment_id_t seg, const ProcessGroup & processGroup )
+:segmentSize( 0 ), group( processGroup ), realInput( false ), batchCount( 1 )
 {
   pRdmaSegment = NULL;
   used_segment = seg;
   gaspi_segment_ptr( used_segment , &pRdmaSegment );
-  gaspi_proc_rank( &rank );
+  rank      = group.getRank();
+  nodecount = group.getSize();
+  nodeRanks.resize(nodecount);
+  for (unsigned int r = 0; r < nodecount; r++)
+    nodeRanks[r] = r;
+  hostRanks = 1;
   timeout = GASPI_BLOCK;
   flag_value = 42;
+  nextQueue = 0;
+  queuePosted.assign(queueCount, false);
+  sharedSegment = false;
+  notifySpan = 0;
+  epoch = 0;
 }
 //------------------------------------------------------------------------------
-void RdmaManager::destroyInstance()
+/*
+ * Hands out the next count notification ids of the segment, so every
+ * operation of a runtime waits on its own range. Called in the same order
+ * on all ranks before the first transfer. The reserved ids are repeated
+ * for every epoch, consecutive transforms alternate between the epochs and
+ * a late notification of one transform never matches the next one.
+ */
+template <typename T>
+gaspi_notification_id_t
+RdmaManager<T>::reserveNotifications(gaspi_notification_id_t count)
 {
-  if (singleton != NULL) 
+  gaspi_number_t available = 0;
+  gaspi_notification_id_t base = notifySpan;
+
+  gaspi_notification_num( &available );
+  if ((unsigned long) (notifySpan + count) * epochCount > available)
   {
-    delete singleton;
-    singleton = NULL;
+    std::cerr << "ERROR # reserveNotifications # " << notifySpan + count
+        << " ids per epoch exceed the " << available
+        << " notifications of the segment" << std::endl;
+    exit(2);
   }
+  notifySpan += count;
+  return base;
 }
-
 //------------------------------------------------------------------------------
-void * RdmaManager::getRdmaPointer()
+/*
+ * Switches to the ids of the next epoch, called collectively at the start
+ * of every transform
+ */
+template <typename T>
+void RdmaManager<T>::nextEpoch()
 {
-  gaspi_segment_ptr( used_segment , &pRdmaSegment );
-  return pRdmaSegment;
+  epoch = (epoch + 1) % epochCount;
 }
+//------------------------------------------------------------------------------
+/*
+ * Number of GASPI queues the transfers are striped over, at most the
+ * number of queues of the GASPI configuration
+ */
+template <typename T>
+void RdmaManager<T>::setQueueCount(unsigned int queues)
+{
+  gaspi_number_t available = 1;
+  gaspi_queue_num( &available );
 
+  queueCount = queues > 0 ? queues : 1;
+  if (queueCount > available)
+  {
+    std::cerr << "WARNING # setQueueCount # only " << available
+        << " queues available" << std::endl;
+    queueCount = available;
+  }
+}
 //------------------------------------------------------------------------------
-fftw_complex * RdmaManager::getStartAddress()
+template <typename T>
+unsigned int RdmaManager<T>::getQueueCount()
 {
-  gaspi_pointer_t pSegment = NULL;
-  gaspi_segment_ptr( used_segment , &pSegment );
-  return ((fftw_complex *) pRdmaSegment);
+  return queueCount;
 }
-
 //------------------------------------------------------------------------------
-void RdmaManager::setCalcOffsets(unsigned long calcoffset_1,
-    unsigned long calcoffset_2)
+/*
+ * Every rank reads its input from path instead of the distribution of the
+ * generated test signal
+ */
+template <typename T>
+void RdmaManager<T>::setInputFile(const std::string & path, input_format_t format)
 {
-  calcOffset_1 = calcoffset_1;
-  calcOffset_2 = calcoffset_2;
+  delete inputFile;
+  inputFile = new InputFile(path, format);
 }
+//------------------------------------------------------------------------------
+template <typename T>
+bool RdmaManager<T>::hasInputFile()
+{
+  return inputFile != NULL;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+bool RdmaManager<T>::hasSharedMemory()
+{
+  return sharedMemory;
+}
+//------------------------------------------------------------------------------
+/*
+ * Segments are created in shared memory, so transfers between ranks of
+ * the same host become plain copies
+ */
+template <typename T>
+void RdmaManager<T>::setSharedMemory(bool shared)
+{
+  sharedMemory = shared;
+}
+//------------------------------------------------------------------------------
+/*
+ * Creates the segment with exactly the regions of layout, the size may
+ * differ between the ranks
+ */
+template <typename T>
+void RdmaManager<T>::createSegment( const SegmentLayout & layout )
+{
+  if (sharedMemory)
+  {
+    createSharedSegment( layout );
+    return;
+  }
 
+  gaspi_return_t ret = gaspi_segment_create( used_segment,
+                                             layout.getSize(),
+                                             group.getGroup(),
+                                             GASPI_BLOCK,
+                                             GASPI_MEM_INITIALIZED );
+  if (ret != GASPI_SUCCESS)
+  {
+    std::cerr << "ERROR # createSegment() # segment " << (int) used_segment
+        << " of " << layout.getSize() << " bytes failed" << std::endl;
+    exit(2);
+  }
+  segmentSize       = layout.getSize();
+  calcOffset_1      = layout.getCalcOffset1();
+  recvBuffersOffset = layout.getRecvOffset();
+  initialOffset_1   = layout.getInitialOffset1();
+  gaspi_segment_ptr( used_segment , &pRdmaSegment );
+  gaspi_printf("segment size in bytes         : %lu\n", segmentSize);
+}
 //------------------------------------------------------------------------------
-fftw_complex * RdmaManager::operator [](size_t idx)
+/*
+ * Hash of the host name, ranks with the same id share the memory
+ */
+static unsigned long hostId()
+{
+  char name[256];
+  unsigned long id = 5381;
+
+  if (gethostname(name, sizeof(name)) != 0)
+    return 0;
+  name[sizeof(name) - 1] = 0;
+  for (const char * c = name; *c; c++)
+    id = id * 33 + (unsigned char) *c;
+  return id;
+}
+//------------------------------------------------------------------------------
+/*
+ * With shared memory the ranks of host h (in the order of the first rank
+ * on each host), numbered l = 0, 1, ... in group rank order, get node id
+ * l * hosts + h if every host runs the same number of ranks. Node ids
+ * which are a multiple of hosts apart then share the host, a merge group
+ * of such a stride stays on it. The master keeps node id 0. Collective,
+ * has to be called before the node ids are used.
+ */
+template <typename T>
+void RdmaManager<T>::placeByHost()
 {
-  char *ptr = (char *) pRdmaSegment;
-  if ((idx < bufferlength) && (idx >= 0)) 
+  if (!sharedMemory)
+    return;
+
+  std::vector<unsigned long> hosts(nodecount);
+  gaspi_allgather_ulong( hostId(), &hosts[0], group.getRank(), nodecount,
+                         group.getGroup() );
+
+  std::vector<unsigned long> ids;
+  std::vector<unsigned int>  counts;
+  std::vector<unsigned int>  hostOf(nodecount);
+  std::vector<unsigned int>  localOf(nodecount);
+  for (unsigned int r = 0; r < nodecount; r++)
   {
-    ptr += calcOffset_1 + (sizeof(fftw_complex) * idx);
-    fftw_complex * tmp = (fftw_complex *) ptr;
-    return tmp;
+    unsigned int h = 0;
+    while (h < ids.size() && ids[h] != hosts[r])
+      h++;
+    if (h == ids.size())
+    {
+      ids.push_back(hosts[r]);
+      counts.push_back(0);
+    }
+    hostOf[r]  = h;
+    localOf[r] = counts[h]++;
   }
-  else if (((idx >= bufferlength) && (idx < (2 * bufferlength))))
+  for (unsigned int h = 0; h < counts.size(); h++)
   {
-    ptr += calcOffset_2 + (sizeof(fftw_complex) * (idx - bufferlength));
-    fftw_complex * tmp = (fftw_complex *) ptr;
-    return tmp;
+    if (counts[h] != counts[0])
+      return;
   }
-  else
+
+  for (unsigned int r = 0; r < nodecount; r++)
   {
-    std::cerr << "ERROR # RdmaManager::operator [] # index out of bound"
-        << std::endl;
-    return NULL;
+    unsigned int node = localOf[r] * ids.size() + hostOf[r];
+    nodeRanks[node] = r;
+    if (r == group.getRank())
+      rank = node;
   }
+  hostRanks = counts[0];
 }
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getRecvBuffersOffset( void )
+template <typename T>
+std::string RdmaManager<T>::sharedName( unsigned long pid )
 {
-  return recvBuffersOffset;
+  std::ostringstream name;
+  name << "/gaspi-fft." << pid << "." << (int) used_segment;
+  return name.str();
 }
 //------------------------------------------------------------------------------
-void RdmaManager::setRecvBuffersOffset(unsigned long offset)
+/*
+ * The segment is a POSIX shared memory object registered with
+ * gaspi_segment_use. The ranks of the group exchange host and process
+ * ids, every rank maps the objects of the ranks on its host. The names
+ * are removed once all ranks mapped them, so nothing is left behind.
+ * A peer which can't be mapped is reached with gaspi_write.
+ */
+template <typename T>
+void RdmaManager<T>::createSharedSegment( const SegmentLayout & layout )
 {
-  recvBuffersOffset = offset;
-}
+  std::string name = sharedName( getpid() );
+  unsigned long size = layout.getSize();
 
-//------------------------------------------------------------------------------
-fftw_complex RdmaManager::getLocalElement(size_t idx)
-{
-  char *ptr = (char *) pRdmaSegment;
-  if (idx > bufferlength)
+  int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+  if (fd < 0 || ftruncate( fd, size ) != 0)
   {
-    std::cerr << "ERROR # RdmaManager::getLocalElement # Index is to high"
-        << std::endl;
-    return 0.0;
+    std::cerr << "ERROR # createSegment() # shared memory " << name
+        << " of " << size << " bytes failed" << std::endl;
+    exit(2);
   }
-  else if (idx < 0)
+  pRdmaSegment = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+  if (pRdmaSegment == MAP_FAILED
+      || gaspi_segment_use( used_segment, pRdmaSegment, size, group.getGroup(),
+                            GASPI_BLOCK, 0 ) != GASPI_SUCCESS)
   {
-    std::cerr << "ERROR # RdmaManager::getLocalElement # Index lesser than 0"
-        << std::endl;
-    return 0.0;
+    std::cerr << "ERROR # createSegment() # segment " << (int) used_segment
+        << " in shared memory failed" << std::endl;
+    exit(2);
   }
-  
-  if (sendbuffer == calc_buffer1)
-    ptr += calcOffset_2;
-  else if (sendbuffer == calc_buffer2)
-    ptr += calcOffset_1;
-  else
+  sharedSegment     = true;
+  segmentSize       = size;
+  calcOffset_1      = layout.getCalcOffset1();
+  recvBuffersOffset = layout.getRecvOffset();
+  initialOffset_1   = layout.getInitialOffset1();
+
+  std::vector<unsigned long> hosts(nodecount);
+  std::vector<unsigned long> pids(nodecount);
+  gaspi_allgather_ulong( hostId(), &hosts[0], rank, nodecount, group.getGroup() );
+  gaspi_allgather_ulong( getpid(), &pids[0], rank, nodecount, group.getGroup() );
+
+  unsigned int peers = 0;
+  peerSegments.assign(nodecount, NULL);
+  peerSizes.assign(nodecount, 0);
+  for (unsigned int r = 0; r < nodecount; r++)
   {
-    std::cerr << "unexpected value of sendbuffer in getLocalElement"
-        << std::endl;
-    return 0.0;
+    struct stat info;
+
+    if (r == rank || hosts[r] != hosts[rank])
+      continue;
+
+    int peerFd = shm_open( sharedName( pids[r] ).c_str(), O_RDWR, 0 );
+    if (peerFd < 0)
+      continue;
+    if (fstat( peerFd, &info ) == 0)
+    {
+      void * peer = mmap( NULL, info.st_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, peerFd, 0 );
+      if (peer != MAP_FAILED)
+      {
+        peerSegments[r] = (char *) peer;
+        peerSizes[r]    = info.st_size;
+        peers++;
+      }
+    }
+    close( peerFd );
   }
-  return (((fftw_complex *) ptr)[idx]);
-}
+  gaspi_barrier( group.getGroup(), GASPI_BLOCK );
+  shm_unlink( name.c_str() );
 
+  gaspi_printf("segment size in bytes         : %lu\n", segmentSize);
+  gaspi_printf("peers on the same host        : %u\n", peers);
+}
 //------------------------------------------------------------------------------
-fftw_complex RdmaManager::getRemoteElement(size_t idx, unsigned int level)
+template <typename T>
+RdmaManager<T>::~RdmaManager()
 {
-  char *ptr = (char *) pRdmaSegment;
-  if (idx > bufferlength) 
+  if (segmentSize > 0)
   {
-    std::cerr << "ERROR # RdmaManager::getRemoteElement # Index is to high"
-        << std::endl;
-    return 0.0;
+    gaspi_segment_delete( used_segment );
   }
-  else if (idx < 0)
+  if (sharedSegment)
   {
-    std::cerr << "ERROR # RdmaManager::getRemoteElement # Index lesser than 0"
-        << std::endl;
-    return 0.0;
+    for (unsigned int r = 0; r < peerSegments.size(); r++)
+    {
+      if (peerSegments[r] != NULL)
+        munmap( peerSegments[r], peerSizes[r] );
+    }
+    munmap( pRdmaSegment, segmentSize );
   }
-  ptr += allNodes[level].recvBuffer_Offset;
+}
 
-  return (((fftw_complex *) ptr)[idx]);
+//------------------------------------------------------------------------------
+template <typename T>
+void * RdmaManager<T>::getRdmaPointer()
+{
+  gaspi_segment_ptr( used_segment , &pRdmaSegment );
+  return pRdmaSegment;
 }
 
 //------------------------------------------------------------------------------
-fftw_complex RdmaManager::getVectorElement(size_t idx, unsigned int level)
+template <typename T>
+typename RdmaManager<T>::complex_t * RdmaManager<T>::getStartAddress()
 {
-  if ((idx < bufferlength) && (sendbuffer == calc_buffer2))
-    return getLocalElement(idx);
-  else if ((idx >= bufferlength) && (sendbuffer != calc_buffer2))
-    return getLocalElement(idx - bufferlength);
-  else if ((idx >= bufferlength) && (sendbuffer == calc_buffer2))
-    return getRemoteElement(idx - bufferlength, level);
-  else if (((idx < bufferlength) && (sendbuffer != calc_buffer2)))
-    return getRemoteElement(idx, level);
-  else
-    std::cerr
-        << "unexpected combination of index and sendbuffer in getVectorElement() "
-        << std::endl;
-  return 0.0;
+  gaspi_pointer_t pSegment = NULL;
+  gaspi_segment_ptr( used_segment , &pSegment );
+  return ((complex_t *) pRdmaSegment);
+}
+
+
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long RdmaManager<T>::getRecvBuffersOffset( void )
+{
+  return recvBuffersOffset;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long RdmaManager<T>::getSegmentSize()
+{
+  return segmentSize;
 }
 
 //------------------------------------------------------------------------------
-void RdmaManager::checkDmaQueue( gaspi_queue_id_t queue )
+template <typename T>
+void RdmaManager<T>::checkDmaQueue( gaspi_queue_id_t queue )
 {
   gaspi_number_t queue_size = 0;
   gaspi_queue_size( queue , &queue_size);
@@ -189,246 +392,444 @@ void RdmaManager::checkDmaQueue( gaspi_queue_id_t queue )
 
 //------------------------------------------------------------------------------
 /*
- * @Override
- * needed levelcount and nodelist
- * i.e.
- * nodelist[2] = 2^2
- * nodelist[1] = 2^1
- * nodelist[0] = 2^0
+ * Round robin over the queues, a write and its notification always share
+ * the queue since GASPI only orders the requests of one queue
  */
+template <typename T>
+gaspi_queue_id_t RdmaManager<T>::selectQueue()
+{
+  gaspi_queue_id_t queue = nextQueue;
+
+  nextQueue = (nextQueue + 1) % queueCount;
+  queuePosted[queue] = true;
+  return queue;
+}
+
+//------------------------------------------------------------------------------
 /*
- * Initialisierung allNodes[node]->recvBuffer_Offset ändern
- * Jede Node schreibt den passenden Offset zu seinem Recv-Buffer
- * in die Nachbarhosts , damit hat jede Node nur einen Offsetwert
- * von jeder Node
+ * Waits for the local completion of the queues with requests posted since
+ * the last call, afterwards the sent buffers may be reused
  */
+template <typename T>
+void RdmaManager<T>::waitOnQueues()
+{
+  testQueues( true );
+}
 
 //------------------------------------------------------------------------------
-bool RdmaManager::writeVectorToNode(int level)
+/*
+ * waitOnQueues() which only blocks with block set, returns false while
+ * a queue is still busy
+ */
+template <typename T>
+bool RdmaManager<T>::testQueues( bool block )
 {
-  unsigned int sendOffset = 0;
-  gaspi_return_t ret;
-
-  if (sendbuffer == calc_buffer2)
+  for (gaspi_queue_id_t queue = 0; queue < queueCount; queue++)
   {
-    sendOffset = calcOffset_2;
-  }
-  else if (sendbuffer == calc_buffer1)
-  {
-    sendOffset = calcOffset_1;
-  }
-
-  unsigned long remoteOffset = allNodes[level].recvBuffer_Offset;
-  gaspi_queue_id_t queue0  = 0;
-  unsigned int nodeid = allNodes[level].nodeid;
+    if (!queuePosted[queue])
+      continue;
 
+    gaspi_return_t ret = gaspi_wait( queue , block ? GASPI_BLOCK : GASPI_TEST );
+    if( ret == GASPI_TIMEOUT )
+    {
+      return false;
+    }
+    if( ret == GASPI_ERROR )
+    {
+      gaspi_printf("wait failed\n");
+    }
+    queuePosted[queue] = false;
+  }
+  return true;
+}
 
-  unsigned long send_size =  bufferlength * sizeof(fftw_complex);
-  int maxSends = 1;
+//------------------------------------------------------------------------------
+template <typename T>
+bool RdmaManager<T>::notifyNode(unsigned int nodeid,
+                                gaspi_notification_id_t notifyId,
+                                gaspi_queue_id_t queue)
+{
+  checkDmaQueue(queue);
+  gaspi_return_t ret = gaspi_notify( used_segment,
+                                     globalRank(nodeid),
+                                     notifyId + epoch * notifySpan,
+                                     flag_value,
+                                     queue,
+                                     GASPI_BLOCK );
+  return ret == GASPI_SUCCESS;
+}
 
-  if (send_size > intMax)
+//------------------------------------------------------------------------------
+template <typename T>
+bool RdmaManager<T>::writeBlock(unsigned int nodeid,
+                             unsigned long localOffset,
+                             unsigned long remoteOffset,
+                             unsigned long size,
+                             gaspi_queue_id_t queue)
+{
+  /* a rank on the same host gets a plain copy, ordered before the notify */
+  if (sharedSegment && peerSegments[nodeid] != NULL)
   {
-    maxSends = send_size / intMax;
-    send_size = intMax;
+    memcpy( peerSegments[nodeid] + remoteOffset,
+            (char *) pRdmaSegment + localOffset, size );
+    __sync_synchronize();
+    return true;
   }
-  for(int i = 0; i < maxSends ; i++)
+
+  /* a single gaspi_write moves at most intMax bytes */
+  for (unsigned long done = 0; done < size; done += intMax)
   {
-    checkDmaQueue(queue0);
-    ret = gaspi_write( used_segment,
-                       sendOffset + (i * send_size),
-                       nodeid,
-                       used_segment,
-                       remoteOffset + (i * send_size),
-                       send_size,
-                       queue0,
-                       GASPI_BLOCK);
+    unsigned long send_size = size - done < intMax ? size - done : intMax;
 
+    checkDmaQueue(queue);
+    gaspi_return_t ret = gaspi_write( used_segment,
+                                      localOffset + done,
+                                      globalRank(nodeid),
+                                      used_segment,
+                                      remoteOffset + done,
+                                      send_size,
+                                      queue,
+                                      GASPI_BLOCK);
     if (ret != GASPI_SUCCESS)
     {
-      std::cerr << "ERROR # writeVectorToNode() # write Dma failed" << std::endl;
-      exit(2);
+      std::cerr << "ERROR # writeBlock() # write Dma failed" << std::endl;
+      return false;
     }
   }
-  ret = gaspi_notify( used_segment,
-		  	  	  	  nodeid,
-					  level,
-					  42,
-					  queue0,
-					  GASPI_BLOCK );
-  gaspi_printf("write notify %d to %d\n", level, nodeid);
-  if (ret != GASPI_SUCCESS)
-  {
-	  std::cerr << "ERROR # writeVectorToNode() # write Dma failed" << std::endl;
-      exit(2);
-  }
-
   return true;
 }
 
 //------------------------------------------------------------------------------
-void RdmaManager::copyCalcBufferToResultBuffer(unsigned long totalVectorLength)
+template <typename T>
+bool RdmaManager<T>::writeTransfers(const std::vector<TransferEntry> & transfers)
 {
+  return writeTransfers(transfers, 0, transfers.size());
+}
 
-  fftw_complex * pEvenSrc = (fftw_complex *) ((char *) pRdmaSegment
-      + calcOffset_1);
-
-  fftw_complex * pEvenDest = (fftw_complex *) ((char *) pRdmaSegment
-      + initialOffset_1);
-
-  memcpy(pEvenDest, pEvenSrc, bufferlength * sizeof(fftw_complex));
-
-  fftw_complex * pOddSrc = (fftw_complex *) ((char *) pRdmaSegment
-      + calcOffset_2);
-
-  fftw_complex * finalVector = (fftw_complex *) (((char *) pRdmaSegment)
-      + getCalcBufferOffset1());
-
-  unsigned long oddEvenDispl = (totalVectorLength / 2) * sizeof(fftw_complex);
-
-
-
-  fftw_complex * pOddDest = (fftw_complex *) ((char *) pRdmaSegment
-      + initialOffset_1 + oddEvenDispl);
+//------------------------------------------------------------------------------
+/*
+ * Writes the entries begin ... end - 1 of transfers, striped over the
+ * queues entry by entry. The merge stages have at least one chunk per
+ * queue, so every block is split over all queues.
+ */
+template <typename T>
+bool RdmaManager<T>::writeTransfers(const std::vector<TransferEntry> & transfers,
+                                    unsigned long begin, unsigned long end)
+{
+  char * ptr = (char *) pRdmaSegment;
 
+  for (unsigned long i = begin; i < end; i++)
+  {
+    const TransferEntry & entry = transfers[i];
 
+    if (entry.nodeid == rank)
+    {
+      memcpy(ptr + entry.remoteOffset, ptr + entry.localOffset, entry.size);
+      continue;
+    }
 
-  memcpy(pOddDest, pOddSrc, bufferlength * sizeof(fftw_complex));
+    gaspi_queue_id_t queue = selectQueue();
+    if (entry.size == 0)
+    {
+      /* the block is final before the peer may read it */
+      __sync_synchronize();
+    }
+    else if (!writeBlock(entry.nodeid, entry.localOffset, entry.remoteOffset,
+                         entry.size, queue))
+    {
+      exit(2);
+    }
 
+    if (!notifyNode(entry.nodeid, entry.notifyId, queue))
+    {
+      std::cerr << "ERROR # writeTransfers() # notify failed" << std::endl;
+      exit(2);
+    }
+  }
+  return true;
 }
 
 //------------------------------------------------------------------------------
-bool RdmaManager::writeResultToMaster(  int reverseBitOrderOfRank,
-                                        unsigned long totalVectorLength )
+/*
+ * The master holds position 0 of the final group, i.e. block j of its
+ * calc buffer starts at element j * totalVectorLength / radix of the result
+ */
+template <typename T>
+void RdmaManager<T>::copyCalcBufferToResultBuffer(unsigned int radix,
+                                               unsigned long blocklength,
+                                               unsigned long totalVectorLength)
 {
+  unsigned long blockDispl = (totalVectorLength / radix) * getElementSize();
 
-  unsigned long evenOffset = initialOffset_1
-      + (reverseBitOrderOfRank * bufferlength * sizeof(fftw_complex));
-
-
-  unsigned long oddOffset = evenOffset
-      + ((totalVectorLength / 2) * sizeof(fftw_complex));
-
-  unsigned long send_size = bufferlength * sizeof(fftw_complex);
+  for (unsigned int j = 0; j < radix; j++)
+  {
+    char * pSrc  = (char *) pRdmaSegment + calcOffset_1
+        + j * blocklength * getElementSize();
 
-  int maxSends = 1;
+    char * pDest = (char *) pRdmaSegment + initialOffset_1 + j * blockDispl;
 
-  if (send_size > intMax)
-  {
-    maxSends = send_size / intMax;
-    send_size = intMax;
+    memcpy(pDest, pSrc, blocklength * getElementSize());
   }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Striped over the queues: piece q of every block goes on its own queue
+ * and is notified with notifyId + q, the master waits on queueCount
+ * notifications per rank
+ */
+template <typename T>
+bool RdmaManager<T>::writeResultToMaster(  unsigned long position,
+                                        unsigned int radix,
+                                        unsigned long blocklength,
+                                        unsigned long totalVectorLength,
+                                        gaspi_notification_id_t notifyId )
+{
+  unsigned long blocksize  = blocklength * getElementSize();
+  unsigned long blockDispl = (totalVectorLength / radix) * getElementSize();
+  unsigned long pieceLength = (blocklength + queueCount - 1) / queueCount;
 
-  for(int i = 0; i < maxSends ; i++)
+  for (unsigned int q = 0; q < queueCount; q++)
   {
-    checkDmaQueue(0);
-    gaspi_return_t ret = gaspi_write( used_segment,
-                                      calcOffset_1 + (i * send_size),
-                                      0,
-                                      used_segment,
-                                      evenOffset + (i * send_size),
-                                      send_size,
-                                      0,
-                                      GASPI_BLOCK);
+    gaspi_queue_id_t queue = selectQueue();
+    unsigned long begin = q * pieceLength < blocklength ? q * pieceLength : blocklength;
+    unsigned long end   = begin + pieceLength < blocklength ? begin + pieceLength : blocklength;
 
-    if (ret != GASPI_SUCCESS ) {
-      std::cerr << "ERROR # writeResultToMaster() # write Dma failed"
-          << std::endl;
-      return false;
+    for (unsigned int j = 0; j < radix && begin < end; j++)
+    {
+      if (!writeBlock( 0,
+                       calcOffset_1 + j * blocksize + begin * getElementSize(),
+                       initialOffset_1 + j * blockDispl + position * blocksize
+                           + begin * getElementSize(),
+                       (end - begin) * getElementSize(),
+                       queue ))
+      {
+        std::cerr << "ERROR # writeResultToMaster() # write Dma failed"
+            << std::endl;
+        return false;
+      }
     }
 
-    checkDmaQueue(0);
-    ret = gaspi_write_notify( used_segment,
-                              calcOffset_2 + (i * send_size),
-                              0,
-                              used_segment,
-                              oddOffset + (i * send_size),
-                              send_size,
-                              ((int) log2(nodecount)) + rank,
-                              42,
-                              0,
-                              GASPI_BLOCK);
-    if (ret != GASPI_SUCCESS) {
-      std::cerr << "ERROR # writeResultToMaster() # write Dma failed"
+    if (!notifyNode(0, notifyId + q, queue)) {
+      std::cerr << "ERROR # writeResultToMaster() # notify failed"
           << std::endl;
       return false;
     }
-
   }
   return true;
 }
 
 //------------------------------------------------------------------------------
-void RdmaManager::initialNodeEntries(int * nodes, unsigned int nodeCount)
+/*
+ * The local signal of rank r lands at element r * length of the master
+ */
+template <typename T>
+bool RdmaManager<T>::writeSignalToMaster(unsigned long length,
+                                         gaspi_notification_id_t notifyId)
 {
-  for (unsigned int i = 0; i < nodeCount; i++) {
-    allNodes.push_back(RemoteNodeEntry());
-    allNodes[i].nodeid = nodes[i];
-    allNodes[i].recvBuffer_Offset = recvBuffersOffset
-        + ( bufferlength * sizeof(fftw_complex) ) * i;
+  unsigned long size = length * getElementSize();
+
+  return writeBlockToMaster(initialOffset_1, initialOffset_1 + rank * size,
+                            size, notifyId);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+bool RdmaManager<T>::writeBlockToMaster(unsigned long localOffset,
+                                        unsigned long remoteOffset,
+                                        unsigned long size,
+                                        gaspi_notification_id_t notifyId)
+{
+  gaspi_queue_id_t queue = selectQueue();
+
+  if (!writeBlock( 0,
+                   localOffset,
+                   remoteOffset,
+                   size,
+                   queue ))
+  {
+    std::cerr << "ERROR # writeBlockToMaster() # write Dma failed"
+        << std::endl;
+    return false;
   }
+
+  if (!notifyNode(0, notifyId, queue)) {
+    std::cerr << "ERROR # writeBlockToMaster() # notify failed"
+        << std::endl;
+    return false;
+  }
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void RdmaManager::printNodeEntries()
+/*
+ * Rank r held the elements r + i * nodecount, back to natural order
+ */
+template <typename T>
+void RdmaManager<T>::sortGatheredSignal(unsigned long length)
 {
-  for (unsigned long i = 0; i < allNodes.size(); i++) {
-    gaspi_printf("Level %ld id %d bufferoffset1: %ld\n", i, allNodes[i].nodeid,
-        allNodes[i].recvBuffer_Offset);
+  char * pResult = (char *) pRdmaSegment + initialOffset_1;
+  unsigned long elementSize = getElementSize();
+  char * pStaged = new char[length * nodecount * elementSize];
+
+  memcpy(pStaged, pResult, length * nodecount * elementSize);
+  for (unsigned int r = 0; r < nodecount; r++)
+  {
+    for (unsigned long i = 0; i < length; i++)
+    {
+      memcpy(pResult + (r + i * nodecount) * elementSize,
+             pStaged + (r * length + i) * elementSize, elementSize);
+    }
   }
+  delete[] pStaged;
 }
 
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getBufferLength()
+template <typename T>
+unsigned long RdmaManager<T>::getBufferLength()
 {
   return bufferlength;
 }
 
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getCalcBufferOffset1()
+template <typename T>
+unsigned long RdmaManager<T>::getCalcBufferOffset1()
 {
   return calcOffset_1;
 }
 
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getCalcBufferOffset2()
+template <typename T>
+unsigned long RdmaManager<T>::getInitialOffset1()
 {
-  return calcOffset_2;
+  return initialOffset_1;
 }
 
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getInitialOffset1()
+template <typename T>
+void RdmaManager<T>::setLengthperBuffer(unsigned long length)
 {
-  return initialOffset_1;
+  bufferlength = length;
 }
 
 //------------------------------------------------------------------------------
-unsigned long RdmaManager::getInitialOffset2()
+template <typename T>
+const ProcessGroup & RdmaManager<T>::getGroup()
 {
-  return initialOffset_2;
+  return group;
 }
-
 //------------------------------------------------------------------------------
-void RdmaManager::setLengthperBuffer(unsigned long length)
+template <typename T>
+unsigned int RdmaManager<T>::getNodeId()
 {
-  bufferlength = length;
+  return rank;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned int RdmaManager<T>::getHostRanks()
+{
+  return hostRanks;
 }
-
 //------------------------------------------------------------------------------
-void RdmaManager::setNodeCount(unsigned int nodeCount)
+/*
+ * Segment of node nodeid in this process, the own one or the mapping of a
+ * rank on the same host, NULL if it isn't mapped
+ */
+template <typename T>
+char * RdmaManager<T>::getNodeSegment(unsigned int nodeid)
+{
+  if (nodeid == rank)
+    return (char *) pRdmaSegment;
+  return sharedSegment ? peerSegments[nodeid] : NULL;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+gaspi_rank_t RdmaManager<T>::globalRank(unsigned int nodeid)
+{
+  return group.getGlobalRank(nodeRanks[nodeid]);
+}
+//------------------------------------------------------------------------------
+template <typename T>
+void RdmaManager<T>::setNodeCount(unsigned int nodeCount)
 {
   nodecount = nodeCount;
 }
 
 //------------------------------------------------------------------------------
-void RdmaManager::setInitialOffsets(unsigned long offset1,
-    unsigned long offset2)
+/*
+ * With real input the vector holds the packed signal
+ * z[t] = x[2t] + I x[2t+1] of 2 * totalVectorLength real samples
+ */
+template <typename T>
+void RdmaManager<T>::setRealInput(bool real)
+{
+  realInput = real;
+}
+//------------------------------------------------------------------------------
+/*
+ * A batch of vectors is stored interleaved, an element of the layout
+ * holds the values of all batchCount vectors at one index
+ */
+template <typename T>
+void RdmaManager<T>::setBatchCount(unsigned int batch)
 {
-  initialOffset_1 = offset1;
-  initialOffset_2 = offset2;
+  batchCount = batch;
 }
 //------------------------------------------------------------------------------
-double RdmaManager::generateFakeData(size_t idx , unsigned long totalVectorLength)
+template <typename T>
+unsigned int RdmaManager<T>::getBatchCount()
 {
+  return batchCount;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long RdmaManager<T>::getElementSize()
+{
+  return batchCount * sizeof(complex_t);
+}
+//------------------------------------------------------------------------------
+template <typename T>
+typename RdmaManager<T>::complex_t
+RdmaManager<T>::generateFakeInput(size_t idx , unsigned long totalVectorLength,
+                                  unsigned int vector)
+{
+  if (!realInput)
+  {
+    return generateFakeData(idx, totalVectorLength, vector);
+  }
+  return generateFakeData(2 * idx, 2 * totalVectorLength, vector)
+      + I * generateFakeData(2 * idx + 1, 2 * totalVectorLength, vector);
+}
+//------------------------------------------------------------------------------
+/*
+ * The input of vector of the batch in natural order, packed with real
+ * input, for the reference transforms of the validation
+ */
+template <typename T>
+void RdmaManager<T>::readInputVector(unsigned int vector,
+                                     unsigned long totalVectorLength,
+                                     fftw_complex * values)
+{
+  if (inputFile != NULL)
+  {
+    inputFile->read(vector, totalVectorLength, realInput,
+                    0, totalVectorLength, values, 1);
+    return;
+  }
+  for (unsigned long i = 0; i < totalVectorLength; i++)
+  {
+    values[i] = generateFakeInput(i, totalVectorLength, vector);
+  }
+}
+//------------------------------------------------------------------------------
+/*
+ * Vector v of a batch is the test signal shifted by v samples
+ */
+template <typename T>
+double RdmaManager<T>::generateFakeData(size_t idx , unsigned long totalVectorLength,
+                                        unsigned int vector)
+{
+  idx = (idx + vector) % totalVectorLength;
   unsigned long sig = totalVectorLength / 8;
   unsigned long i = 1;
   for (; i <= 8; i++) {
@@ -444,92 +845,313 @@ double RdmaManager::generateFakeData(size_t idx , unsigned long totalVectorLengt
   return 0.0;
 }
 //------------------------------------------------------------------------------
-void RdmaManager::waitOnNotifies( gaspi_notification_id_t   id_begin,
+template <typename T>
+void RdmaManager<T>::waitOnNotifies( gaspi_notification_id_t   id_begin,
                                   gaspi_notification_id_t   id_count )
+{
+  waitOnNotifyRange( id_begin , id_count , id_count );
+}
+//------------------------------------------------------------------------------
+/*
+ * Waits until expected notifications of the range
+ * [id_begin, id_begin + id_range) arrived and resets them
+ */
+template <typename T>
+void RdmaManager<T>::waitOnNotifyRange( gaspi_notification_id_t   id_begin,
+                                     gaspi_notification_id_t   id_range,
+                                     unsigned int              expected )
+{
+  testNotifyRange( id_begin , id_range , expected , true );
+}
+//------------------------------------------------------------------------------
+/*
+ * Consumes the notifications of the range which already arrived,
+ * remaining counts down to 0. Only blocks with block set, returns false
+ * while notifications are missing. One waitsome serves every id of the
+ * range from the first arrived one on which is already set.
+ */
+template <typename T>
+bool RdmaManager<T>::testNotifyRange( gaspi_notification_id_t   id_begin,
+                                      gaspi_notification_id_t   id_range,
+                                      unsigned int &            remaining,
+                                      bool                      block )
 {
   gaspi_notification_t    tmp;
   gaspi_return_t          retval;
   gaspi_notification_id_t first_id;
 
-  for( int i = id_begin ; i < ( id_begin + id_count ) ; i++ )
+  id_begin += epoch * notifySpan;
+  while( remaining > 0 )
   {
     retval = gaspi_notify_waitsome( used_segment,
                                     id_begin,
-                                    id_count,
+                                    id_range,
                                     &first_id,
-                                    GASPI_BLOCK );
+                                    block ? GASPI_BLOCK : GASPI_TEST );
 
+    if( retval == GASPI_TIMEOUT )
+    {
+      return false;
+    }
     if( retval == GASPI_ERROR )
     {
-      gaspi_printf("Wait-Error in waitOnInitialVector\n");
+      gaspi_printf("Wait-Error in waitOnNotifyRange\n");
+    }
+    for (gaspi_notification_id_t id = first_id;
+         id < id_begin + id_range && remaining > 0; id++)
+    {
+      gaspi_notify_reset( used_segment, id , &tmp );
+      if (tmp != 0)
+        remaining--;
     }
-    gaspi_notify_reset( used_segment, first_id , &tmp );
   }
+  return true;
 }
 //------------------------------------------------------------------------------
-void RdmaManager::distributeVectors(int splitCount, unsigned long totalVectorLength)
+/*
+ * With an input file the start passes down the tree and the ranks read
+ * contiguous slices and exchange them (exchangeInputFile), notifyId + 1
+ * ... notifyId + nodecount are the ids of the exchange. Otherwise
+ * binomial tree scatter of the generated input, called on all ranks. The vectors of
+ * the subtree of a rank follow each other from initial buffer 1 on, its
+ * own vector first. The master generates the vectors of a child subtree
+ * while the writes to the larger subtrees are in flight, every other
+ * rank waits on notifyId from its parent and forwards the parts of its
+ * children, the largest subtree first.
+ */
+template <typename T>
+void RdmaManager<T>::distributeVectors(int splitCount, unsigned long totalVectorLength,
+                                       gaspi_notification_id_t notifyId)
 {
-  gaspi_segment_id_t GaspiQueue = 0;
-  unsigned long initial_offsets[2] = { initialOffset_1 , initialOffset_2 };
-  unsigned long send_size = bufferlength * splitCount * sizeof(fftw_complex);
-  int maxSends = 1;
-  gaspi_return_t retval;
+  if (scatterNotifyCount() > 0)
+  {
+    waitOnNotifies( notifyId , 1 );
+  }
+  scatterVectors( splitCount , totalVectorLength , notifyId );
+  if (exchangeNotifyCount() > 0)
+  {
+    waitOnNotifyRange( notifyId + 1 , nodecount , exchangeNotifyCount() );
+  }
+  /* the forwarded vectors have to leave before the initial buffers are reused */
+  waitOnQueues();
+}
+//------------------------------------------------------------------------------
+/*
+ * Slices of the other ranks a rank waits on after scatterVectors with an
+ * input file
+ */
+template <typename T>
+unsigned int RdmaManager<T>::exchangeNotifyCount()
+{
+  return inputFile != NULL ? nodecount - 1 : 0;
+}
+//------------------------------------------------------------------------------
+/*
+ * Rank r reads the contiguous elements r * length ... (r + 1) * length - 1
+ * of every vector of the batch in large aligned windows. The elements of
+ * owner d are every nodecount-th of them and are the consecutive elements
+ * first / nodecount ... of d, so the slice is sorted by owner in memory,
+ * each part staged behind the initial buffer and written to its owner
+ * with notifyBase + r.
+ */
+template <typename T>
+void RdmaManager<T>::exchangeInputFile(unsigned long length,
+                                       unsigned long totalVectorLength,
+                                       gaspi_notification_id_t notifyBase)
+{
+  unsigned long first = rank * length;
+  complex_t * slice = new complex_t[length * batchCount];
+  complex_t * pInitialBuffer_1 = (complex_t *) ((char *) pRdmaSegment
+      + initialOffset_1);
+  unsigned long stagingOffset = initialOffset_1 + length * getElementSize();
+  complex_t * pStaging = (complex_t *) ((char *) pRdmaSegment + stagingOffset);
+  unsigned long staged = 0;
 
-  if (send_size > intMax)
+  for (unsigned int v = 0; v < batchCount; v++)
   {
-    maxSends = (send_size / intMax);
-    send_size = intMax;
+    inputFile->read(v, totalVectorLength, realInput, first, length,
+                    slice + v, batchCount);
   }
 
-  for (int node = 1; node < nodecount; node++)
+  for (unsigned int d = 0; d < nodecount; d++)
   {
-    GaspiQueue = node % 2;
+    unsigned long k = first + (d + nodecount - first % nodecount) % nodecount;
+    unsigned long count = k < first + length
+        ? (first + length - k + nodecount - 1) / nodecount : 0;
+    complex_t * pDest = d == rank ? pInitialBuffer_1 + (k / nodecount) * batchCount
+                                  : pStaging + staged * batchCount;
 
-    fftw_complex * pInitialBuffer = (fftw_complex *) ((char *) pRdmaSegment
-      + initial_offsets[GaspiQueue]);
+    for (unsigned long i = 0; i < count; i++)
+    {
+      for (unsigned int v = 0; v < batchCount; v++)
+      {
+        pDest[i * batchCount + v] = slice[(k - first + i * nodecount) * batchCount + v];
+      }
+    }
+    if (d == rank || count == 0)
+    {
+      if (d != rank && !notifyNode(d, notifyBase + rank, selectQueue()))
+      {
+        std::cerr << "notify failed in function exchangeInputFile()"
+        << std::endl;
+        exit(2);
+      }
+      continue;
+    }
 
-    for (unsigned long i = 0; i < (bufferlength * splitCount); i++)
+    gaspi_queue_id_t queue = selectQueue();
+    if (!writeBlock(d, stagingOffset + staged * getElementSize(),
+                    initialOffset_1 + (k / nodecount) * getElementSize(),
+                    count * getElementSize(), queue)
+        || !notifyNode(d, notifyBase + rank, queue))
     {
-      pInitialBuffer[i] = generateFakeData(node + (i * nodecount),totalVectorLength);
+      std::cerr << "write_notify failed in function exchangeInputFile()"
+      << std::endl;
+      exit(2);
     }
+    staged += count;
+  }
+  delete[] slice;
+}
+//------------------------------------------------------------------------------
+/*
+ * Notifications a rank waits on before scatterVectors, 1 from its parent
+ * in the tree on every rank but the master. With an input file the
+ * notification carries no data, it only passes the start down the tree.
+ */
+template <typename T>
+unsigned int RdmaManager<T>::scatterNotifyCount()
+{
+  return rank != 0 ? 1 : 0;
+}
+//------------------------------------------------------------------------------
+/*
+ * Number of children of the rank in the scatter tree
+ */
+template <typename T>
+unsigned int RdmaManager<T>::scatterChildCount()
+{
+  int parent;
+  int * children = NULL;
+  int childCount = calculate_comm_partners( &parent , &children , rank , 0 , nodecount );
+
+  free( children );
+  return childCount;
+}
+//------------------------------------------------------------------------------
+/*
+ * Tells the parent in the scatter tree that the rank and its subtree are
+ * done with the previous transform. Child c of a parent uses the id
+ * readyNotify + log2 of the lowest set bit of c, the children of a rank
+ * so get the ids readyNotify ... readyNotify + scatterChildCount() - 1.
+ */
+template <typename T>
+void RdmaManager<T>::notifyScatterParent(gaspi_notification_id_t readyNotify)
+{
+  gaspi_notification_id_t slot = 0;
+
+  if (rank == 0)
+    return;
+  while (!((rank >> slot) & 1))
+    slot++;
+  if (!notifyNode(rank ^ (1U << slot), readyNotify + slot, selectQueue()))
+  {
+    std::cerr << "notify failed in function notifyScatterParent()"
+    << std::endl;
+    exit(2);
+  }
+}
+//------------------------------------------------------------------------------
+/*
+ * The part of distributeVectors after the notification of the parent
+ * arrived: posts the writes to the children or, with an input file,
+ * notifies them and reads the slice of the rank, all of which the caller
+ * has to complete before the initial buffers are reused. With an input
+ * file the rank then waits on exchangeNotifyCount() notifications of
+ * [notifyId + 1, notifyId + 1 + nodecount).
+ */
+template <typename T>
+void RdmaManager<T>::scatterVectors(int splitCount, unsigned long totalVectorLength,
+                                    gaspi_notification_id_t notifyId)
+{
+  unsigned long length = bufferlength * splitCount;
+  unsigned long blocksize = length * getElementSize();
+  int parent;
+  int * children = NULL;
+  int childCount;
 
-    for (int i = 0; i < maxSends; i++)
+  childCount = calculate_comm_partners( &parent , &children , rank , 0 , nodecount );
+
+  for (int c = childCount - 1; c >= 0; c--)
+  {
+    int child = children[c];
+    unsigned long localOffset = initialOffset_1 + (child - rank) * blocksize;
+    gaspi_queue_id_t queue = selectQueue();
+
+    if (inputFile != NULL)
     {
-      checkDmaQueue(GaspiQueue);
-      retval = gaspi_write(  used_segment,
-                             initial_offsets[node % 2] + (i * send_size),
-                             node,
-                             used_segment,
-                             initialOffset_1 + (i * send_size),
-                             send_size,
-                             GaspiQueue,
-                             GASPI_BLOCK );
-
-      if (retval == GASPI_ERROR)
+      if (!notifyNode(child, notifyId, queue))
       {
-        std::cerr << "write_notify failed in function distributeVectors()"
+        std::cerr << "notify failed in function distributeVectors()"
         << std::endl;
-        return;
+        exit(2);
       }
+      continue;
     }
 
-    retval = gaspi_notify( used_segment, node, rank + 10, flag_value, GaspiQueue, GASPI_BLOCK);
+    if (parent == (int) rank)
+    {
+      complex_t * pSubtree = (complex_t *) ((char *) pRdmaSegment + localOffset);
+      unsigned long span = scatter_span( child , 0 , nodecount );
 
-    if (retval == GASPI_ERROR)
+      for (unsigned long node = 0; node < span; node++)
+      {
+        for (unsigned long i = 0; i < length; i++)
+        {
+          for (unsigned int v = 0; v < batchCount; v++)
+          {
+            pSubtree[(node * length + i) * batchCount + v] =
+                generateFakeInput(child + node + (i * nodecount),totalVectorLength,v);
+          }
+        }
+      }
+    }
+
+    if (!writeBlock(child, localOffset, initialOffset_1,
+                    scatter_span( child , 0 , nodecount ) * blocksize, queue)
+        || !notifyNode(child, notifyId, queue))
     {
-    	std::cerr << "write_notify failed in function distributeVectors()"
-        << std::endl;
-        return;
+      std::cerr << "write_notify failed in function distributeVectors()"
+      << std::endl;
+      exit(2);
     }
   }
+  free( children );
 
-  fftw_complex * pInitialBuffer_1 = (fftw_complex *) ((char *) pRdmaSegment
-      + initialOffset_1);
-
-  gaspi_wait( 0 , GASPI_BLOCK );
+  /* the children start their reads before this one */
+  if (inputFile != NULL)
+  {
+    exchangeInputFile( length , totalVectorLength , notifyId + 1 );
+    return;
+  }
 
-  for (unsigned long i = 0; i < (bufferlength * splitCount); i++)
+  if (parent == (int) rank)
   {
-    pInitialBuffer_1[i] = generateFakeData((i * nodecount),totalVectorLength);
+    complex_t * pInitialBuffer_1 = (complex_t *) ((char *) pRdmaSegment
+        + initialOffset_1);
+
+    for (unsigned long i = 0; i < length; i++)
+    {
+      for (unsigned int v = 0; v < batchCount; v++)
+      {
+        pInitialBuffer_1[i * batchCount + v] =
+            generateFakeInput((i * nodecount),totalVectorLength,v);
+      }
+    }
   }
 }
+
+//------------------------------------------------------------------------------
+template class RdmaManager<float>;
+template class RdmaManager<double>;
+template class RdmaManager<long double>;
@@ -7,85 +7,179 @@
 
 #ifndef LOCAL_RDMA_HPP_
 #define LOCAL_RDMA_HPP_
-#include <complex.h>
-#include <fftw3.h>
-
-
-
 #include <vector>
+#include <string>
 #include "utils.hpp"
+#include "fftw_traits.hpp"
+#include "segment_layout.hpp"
+#include "input_file.hpp"
+#include "process_group.hpp"
 
+/*
+ * Segment layout and one-sided communication of a transform with
+ * complex values of precision T. Every runtime owns its manager and
+ * segment, so one process can hold several transforms as long as their
+ * segment ids differ. Queues and the input file are shared. Node ids are
+ * ranks of the process group the segment belongs to, unless placeByHost()
+ * orders them by host. With shared memory the segment lives in a POSIX
+ * shared memory object and ranks on the same host map each other's
+ * segment (getNodeSegment()), so they can read the data of a peer in
+ * place. Transfers to them are plain copies instead of gaspi_write.
+ */
+template <typename T>
 class RdmaManager {
 
 public:
-  struct RemoteNodeEntry
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  /*
+   * One block of the local segment which has to be placed at remoteOffset
+   * on node nodeid. Transfers to the own rank are plain copies and don't
+   * notify. Entries of size 0 only notify, the peer reads the block from
+   * its mapping of the segment.
+   */
+  struct TransferEntry
   {
-    unsigned int    nodeid;
-    unsigned long   recvBuffer_Offset;
+    unsigned int            nodeid;
+    unsigned long           localOffset;
+    unsigned long           remoteOffset;
+    unsigned long           size;
+    gaspi_notification_id_t notifyId;
   };
-  std::vector<RemoteNodeEntry> allNodes;
-  use_calcBuffer_t             calcBuffer;
-  send_t                       sendbuffer;
 
-  static RdmaManager* getInstance( void );
-  void                initial( gaspi_segment_id_t seg );
-  void                destroyInstance();
-  void                checkDmaQueue(gaspi_queue_id_t queue);
+  RdmaManager( gaspi_segment_id_t seg, const ProcessGroup & group );
+  ~RdmaManager();
 
-  void                setCalcOffsets(unsigned long calcoffset_1, unsigned long calcoffset_2);
-  void                setRecvBuffersOffset(unsigned long offset);
+  void                createSegment( const SegmentLayout & layout );
+  void                checkDmaQueue(gaspi_queue_id_t queue);
+  void                waitOnQueues();
+  bool                testQueues( bool block );
+  gaspi_notification_id_t reserveNotifications(gaspi_notification_id_t count);
+  void                nextEpoch();
+  static void         setQueueCount(unsigned int queues);
+  static unsigned int getQueueCount();
+  static void         setInputFile(const std::string & path, input_format_t format);
+  static void         setSharedMemory(bool shared);
+  static bool         hasInputFile();
+  static bool         hasSharedMemory();
+
+  const ProcessGroup & getGroup();
+  void                placeByHost();
+  unsigned int        getNodeId();
+  unsigned int        getHostRanks();
+  char*               getNodeSegment(unsigned int nodeid);
   void                setLengthperBuffer(unsigned long length);
-  void                setCalcBuffer(use_calcBuffer_t buffer);
   void                setNodeCount(unsigned int nodeCount);
-  void                setInitialOffsets(unsigned long offset1, unsigned long offset2);
+  void                setRealInput(bool real);
+  void                setBatchCount(unsigned int batch);
+  unsigned int        getBatchCount();
+  unsigned long       getElementSize();
 
   void*               getRdmaPointer();
-  fftw_complex*       getStartAddress();
+  complex_t*          getStartAddress();
   unsigned long       getBufferLength();
   unsigned long       getCalcBufferOffset1();
-  unsigned long       getCalcBufferOffset2();
   unsigned long       getInitialOffset1();
-  unsigned long       getInitialOffset2();
-  fftw_complex        getVectorElement(size_t idx, unsigned int level);
 
   unsigned long       getRecvBuffersOffset( void );
+  unsigned long       getSegmentSize();
 
   void                waitOnNotifies( gaspi_notification_id_t   id_begin,
                                       gaspi_notification_id_t   id_count );
-  void                distributeVectors(int splitCount, unsigned long totalVectorLength);
-  bool                writeVectorToNode(int level);
-  bool                writeResultToMaster(int reverseBitOrderOfRank, unsigned long totalVectorLength);
-  void                copyCalcBufferToResultBuffer(unsigned long totalVectorLength);
-  void                printNodeEntries();
-  void                initialNodeEntries(int * nodes, unsigned int nodeCount);
-  double              generateFakeData(size_t idx , unsigned long totalVectorLength);
-
-  fftw_complex *      operator [](size_t idx);
+  void                waitOnNotifyRange( gaspi_notification_id_t   id_begin,
+                                         gaspi_notification_id_t   id_range,
+                                         unsigned int              expected );
+  bool                testNotifyRange( gaspi_notification_id_t   id_begin,
+                                       gaspi_notification_id_t   id_range,
+                                       unsigned int &            remaining,
+                                       bool                      block );
+  void                distributeVectors(int splitCount, unsigned long totalVectorLength,
+                                        gaspi_notification_id_t notifyId);
+  unsigned int        scatterNotifyCount();
+  unsigned int        exchangeNotifyCount();
+  unsigned int        scatterChildCount();
+  void                notifyScatterParent(gaspi_notification_id_t readyNotify);
+  void                scatterVectors(int splitCount, unsigned long totalVectorLength,
+                                     gaspi_notification_id_t notifyId);
+  bool                writeTransfers(const std::vector<TransferEntry> & transfers);
+  bool                writeTransfers(const std::vector<TransferEntry> & transfers,
+                                     unsigned long begin, unsigned long end);
+  bool                writeResultToMaster(unsigned long position,
+                                          unsigned int radix,
+                                          unsigned long blocklength,
+                                          unsigned long totalVectorLength,
+                                          gaspi_notification_id_t notifyId);
+  void                copyCalcBufferToResultBuffer(unsigned int radix,
+                                                   unsigned long blocklength,
+                                                   unsigned long totalVectorLength);
+  bool                writeSignalToMaster(unsigned long length,
+                                          gaspi_notification_id_t notifyId);
+  void                sortGatheredSignal(unsigned long length);
+  bool                writeBlockToMaster(unsigned long localOffset,
+                                         unsigned long remoteOffset,
+                                         unsigned long size,
+                                         gaspi_notification_id_t notifyId);
+  void                readInputVector(unsigned int vector,
+                                      unsigned long totalVectorLength,
+                                      fftw_complex * values);
+  double              generateFakeData(size_t idx , unsigned long totalVectorLength,
+                                       unsigned int vector = 0);
+  complex_t           generateFakeInput(size_t idx , unsigned long totalVectorLength,
+                                        unsigned int vector = 0);
 
 private:
   static const unsigned int intMax = 1073741824;
+  static const unsigned int epochCount = 2;
   gaspi_timeout_t     timeout;
 
   unsigned long       recvBuffersOffset;
   unsigned long       notifyOffset;
   unsigned long       calcOffset_1;
-  unsigned long       calcOffset_2;
   unsigned long       initialOffset_1;
-  unsigned long       initialOffset_2;
   unsigned long       bufferlength;
-  static RdmaManager* singleton;
+  unsigned long       segmentSize;
+  static unsigned int queueCount;
+  static InputFile *  inputFile;
+  static bool         sharedMemory;
 
   void*                pRdmaSegment;
   gaspi_segment_id_t   used_segment;
+  const ProcessGroup & group;
   unsigned int         nodecount;
   gaspi_rank_t         rank;
+  /* group rank of every node id */
+  std::vector<gaspi_rank_t> nodeRanks;
+  /* ranks on every host after placeByHost(), 1 if they aren't placed */
+  unsigned int         hostRanks;
   gaspi_notification_t flag_value;
-
-  fftw_complex          getLocalElement(size_t idx);
-  fftw_complex          getRemoteElement(size_t idx, unsigned int level);
-
-  RdmaManager(){}
-  ~RdmaManager(){}
-
+  bool                 realInput;
+  unsigned int         batchCount;
+  gaspi_queue_id_t     nextQueue;
+  std::vector<bool>    queuePosted;
+  bool                 sharedSegment;
+  /* mapped segments of the ranks on the same host, NULL for the others */
+  std::vector<char *>        peerSegments;
+  std::vector<unsigned long> peerSizes;
+  gaspi_notification_id_t notifySpan;
+  unsigned int         epoch;
+
+  void                  createSharedSegment( const SegmentLayout & layout );
+  std::string           sharedName( unsigned long pid );
+  gaspi_rank_t          globalRank(unsigned int nodeid);
+  gaspi_queue_id_t      selectQueue();
+  bool                  writeBlock(unsigned int nodeid,
+                                   unsigned long localOffset,
+                                   unsigned long remoteOffset,
+                                   unsigned long size,
+                                   gaspi_queue_id_t queue);
+  void                  exchangeInputFile(unsigned long length,
+                                          unsigned long totalVectorLength,
+                                          gaspi_notification_id_t notifyBase);
+  bool                  notifyNode(unsigned int nodeid,
+                                   gaspi_notification_id_t notifyId,
+                                   gaspi_queue_id_t queue);
+
+  RdmaManager(const RdmaManager &);
+  RdmaManager & operator=(const RdmaManager &);
 };
 #endif /* LOCAL_RDMA_HPP_ */
@@ -0,0 +1,82 @@
+/*
+ * result_file.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "result_file.hpp"
+
+//------------------------------------------------------------------------------
+ResultFile::ResultFile(const std::string & filePath, bool create)
+:path( filePath )
+{
+  fd = open(path.c_str(), create ? O_WRONLY | O_CREAT | O_TRUNC : O_WRONLY, 0644);
+  if (fd < 0)
+  {
+    std::cerr << "ERROR # ResultFile # can't open " << path << std::endl;
+    exit(2);
+  }
+}
+
+//------------------------------------------------------------------------------
+ResultFile::~ResultFile()
+{
+  if (fd >= 0)
+    ::close(fd);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Writes the header and extends the file to its final size, so the
+ * ranks only write into allocated space
+ */
+void ResultFile::writeHeader(const ResultHeader & header, unsigned long dataBytes)
+{
+  if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+      || ftruncate(fd, dataOffset + dataBytes) != 0)
+  {
+    std::cerr << "ERROR # ResultFile # header of " << path << " failed"
+        << std::endl;
+    exit(2);
+  }
+}
+
+//------------------------------------------------------------------------------
+/*
+ * size bytes at offset of the spectrum
+ */
+void ResultFile::write(const void * data, unsigned long offset, unsigned long size)
+{
+  const char * pData = (const char *) data;
+  unsigned long done = 0;
+
+  while (done < size)
+  {
+    unsigned long chunk = size - done < maxWrite ? size - done : maxWrite;
+    ssize_t ret = pwrite(fd, pData + done, chunk, dataOffset + offset + done);
+    if (ret <= 0)
+    {
+      std::cerr << "ERROR # ResultFile # write to " << path << " failed"
+          << std::endl;
+      exit(2);
+    }
+    done += ret;
+  }
+}
+
+//------------------------------------------------------------------------------
+void ResultFile::close(bool sync)
+{
+  if (sync && fsync(fd) != 0)
+  {
+    std::cerr << "ERROR # ResultFile # fsync of " << path << " failed"
+        << std::endl;
+    exit(2);
+  }
+  ::close(fd);
+  fd = -1;
+}
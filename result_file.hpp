@@ -0,0 +1,52 @@
+/*
+ * result_file.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef RESULT_FILE_HPP_
+#define RESULT_FILE_HPP_
+#include <string>
+
+/*
+ * Header at the start of a result file, the spectrum follows at
+ * ResultFile::dataOffset. An element holds the values of all batchCount
+ * vectors at one index as interleaved (re, im) pairs of scalarBytes each.
+ */
+struct ResultHeader
+{
+  char          magic[8];
+  unsigned int  version;
+  unsigned int  scalarBytes;
+  unsigned long length;
+  unsigned int  batchCount;
+  unsigned int  ordering;
+};
+
+/*
+ * Binary result shared by all ranks. The master creates the file with
+ * its header, afterwards every rank writes its blocks with pwrite at
+ * their offset in the spectrum.
+ */
+class ResultFile {
+
+public:
+  static const unsigned long dataOffset = 4096;
+  static const unsigned int  orderingNatural = 0;
+
+  ResultFile(const std::string & path, bool create);
+  ~ResultFile();
+
+  void writeHeader(const ResultHeader & header, unsigned long dataBytes);
+  void write(const void * data, unsigned long offset, unsigned long size);
+  void close(bool sync);
+
+private:
+  static const unsigned long maxWrite = 1073741824;
+
+  std::string path;
+  int         fd;
+};
+
+#endif /* RESULT_FILE_HPP_ */
@@ -0,0 +1,55 @@
+/*
+ * segment_layout.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include "segment_layout.hpp"
+
+//------------------------------------------------------------------------------
+SegmentLayout::SegmentLayout(unsigned long calcBytes, unsigned long recvBytes,
+                             unsigned long initialBytes, unsigned long tailBytes)
+{
+  calcOffset1    = 0;
+  recvOffset     = align(calcOffset1 + calcBytes);
+  initialOffset1 = align(recvOffset + recvBytes);
+  size           = align(initialOffset1 + initialBytes + tailBytes);
+}
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::align(unsigned long bytes)
+{
+  return (bytes + regionAlignment - 1) / regionAlignment * regionAlignment;
+}
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::alignLine(unsigned long bytes)
+{
+  return (bytes + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+}
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::getCalcOffset1() const
+{
+  return calcOffset1;
+}
+
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::getRecvOffset() const
+{
+  return recvOffset;
+}
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::getInitialOffset1() const
+{
+  return initialOffset1;
+}
+
+
+//------------------------------------------------------------------------------
+unsigned long SegmentLayout::getSize() const
+{
+  return size;
+}
@@ -0,0 +1,49 @@
+/*
+ * segment_layout.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef SEGMENT_LAYOUT_HPP_
+#define SEGMENT_LAYOUT_HPP_
+
+/*
+ * Exact segment of one rank. The regions follow each other in this order,
+ * each starting at a multiple of regionAlignment:
+ *   calc buffers    : calcBytes
+ *   receive buffers : recvBytes, the runtimes place the buffers of their
+ *                     stages inside at multiples of cacheLineSize
+ *                     (alignLine), so no two stages share a line
+ *   initial buffers : initialBytes on every rank. Each rank appends its
+ *                     own tailBytes directly behind them, the vectors of
+ *                     its subtree of the distribution and on the master
+ *                     the gather area, so the offsets agree on all ranks
+ *                     and remote offsets can be computed locally.
+ */
+class SegmentLayout {
+
+public:
+  static const unsigned long regionAlignment = 4096;
+  static const unsigned long cacheLineSize   = 64;
+
+  SegmentLayout(unsigned long calcBytes, unsigned long recvBytes,
+                unsigned long initialBytes, unsigned long tailBytes);
+
+  unsigned long getCalcOffset1() const;
+  unsigned long getRecvOffset() const;
+  unsigned long getInitialOffset1() const;
+  unsigned long getSize() const;
+
+  static unsigned long alignLine(unsigned long bytes);
+
+private:
+  unsigned long calcOffset1;
+  unsigned long recvOffset;
+  unsigned long initialOffset1;
+  unsigned long size;
+
+  static unsigned long align(unsigned long bytes);
+};
+
+#endif /* SEGMENT_LAYOUT_HPP_ */
@@ -0,0 +1,332 @@
+/*
+ * six_step_runtime.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <string.h>
+#include <assert.h>
+#include <cmath>
+#include "six_step_runtime.hpp"
+#include "fft_computation.hpp"
+
+//------------------------------------------------------------------------------
+unsigned long sixStepColumns(unsigned long length, gaspi_rank_t nodecount)
+{
+  unsigned long columns = 0;
+
+  for (unsigned long c = 1; c * nodecount * c * nodecount <= length; c++)
+  {
+    if (length % (c * nodecount * nodecount) == 0)
+      columns = c;
+  }
+  return columns;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Segment: calc buffer (the local columns, later the local rows), the
+ * receive buffer of the transpose and the initial buffers, which get the
+ * distributed input and hold the gathered result on the master.
+ */
+template <typename T>
+SixStepRuntime<T>::SixStepRuntime(unsigned long vectorlength,
+                                  gaspi_segment_id_t seg,
+                                  const ProcessGroup & processGroup,
+                                  unsigned int plannerFlags)
+:group( processGroup ), master_rank( 0 )
+{
+  rank      = group.getRank();
+  nodecount = group.getSize();
+  totalVectorLength = vectorlength;
+  columns = sixStepColumns(totalVectorLength, nodecount);
+
+  if (columns == 0)
+  {
+    std::cerr << "ERROR # SixStepRuntime # the vector length has to be a "
+        << "multiple of " << (unsigned long) nodecount * nodecount << std::endl;
+    exit(2);
+  }
+  rowLength    = columns * nodecount;
+  columnLength = totalVectorLength / rowLength;
+  localLength  = totalVectorLength / nodecount;
+
+  rdma = new RdmaManager<T>( seg, group );
+  initialOffsets();
+  distributionNotify = rdma->reserveNotifications(1 + nodecount);
+  initialTranspose(rdma->reserveNotifications(nodecount));
+  gatherNotifyBase = rdma->reserveNotifications(nodecount);
+
+  createPlans(plannerFlags);
+  calculateTwiddles();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The same cyclic distribution as the merge engine, called before every
+ * transform
+ */
+template <typename T>
+void SixStepRuntime<T>::loadInput()
+{
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+  rdma->nextEpoch();
+  rdma->distributeVectors(1, totalVectorLength, distributionNotify);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The initial buffers hold the subtree of the distribution, the master
+ * gathers the result from initial buffer 1 on
+ */
+template <typename T>
+void SixStepRuntime<T>::initialOffsets()
+{
+  unsigned long buffersize = localLength * sizeof(complex_t);
+  unsigned long tailsize = rdma->hasInputFile() ? buffersize
+      : (scatter_span(rank, master_rank, nodecount) - 1) * buffersize;
+
+  /* the gather area of the master */
+  if (rank == master_rank)
+    tailsize = (nodecount - 1) * buffersize;
+
+  rdma->setNodeCount(nodecount);
+  rdma->setLengthperBuffer(localLength);
+  rdma->createSegment(SegmentLayout(buffersize, buffersize, buffersize, tailsize));
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The matrix as 3d array of (r, j, k1) with n2 = r + nodecount * j:
+ * rank r holds all k1 of its columns stored as k1 * columns + j, after
+ * the transpose rank q holds its rows of all columns stored as
+ * k1 * N2 + n2.
+ */
+template <typename T>
+void SixStepRuntime<T>::initialTranspose(gaspi_notification_id_t notifyBase)
+{
+  const unsigned int columnOrder[3] = { 0 , 2 , 1 };
+  const unsigned int rowOrder[3]    = { 2 , 1 , 0 };
+  unsigned long rows = columnLength / nodecount;
+  std::vector<Box> inputs(nodecount), outputs(nodecount);
+
+  for (gaspi_rank_t r = 0; r < nodecount; r++)
+  {
+    Box & in  = inputs[r];
+    Box & out = outputs[r];
+
+    in.start[0] = r;  in.count[0] = 1;
+    in.start[1] = 0;  in.count[1] = columns;
+    in.start[2] = 0;  in.count[2] = columnLength;
+
+    out.start[0] = 0;  out.count[0] = nodecount;
+    out.start[1] = 0;  out.count[1] = columns;
+    out.start[2] = r * rows;  out.count[2] = rows;
+
+    for (unsigned int axis = 0; axis < 3; axis++)
+    {
+      in.order[axis]  = columnOrder[axis];
+      out.order[axis] = rowOrder[axis];
+    }
+  }
+  transpose = new Transpose<T>(rdma, inputs, outputs, rdma->getRecvBuffersOffset(),
+                               notifyBase);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The column transform reads the initial buffer and writes the calc
+ * buffer, the row transform works in place. Created before the input is
+ * distributed since FFTW_MEASURE and above overwrite the arrays.
+ */
+template <typename T>
+void SixStepRuntime<T>::createPlans(unsigned int plannerFlags)
+{
+  complex_t * work  = getLocalData();
+  complex_t * input = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+
+  columnPlan = FftwTraits<T>::planManyDft(columnLength, columns,
+      input, columns, 1, work, columns, 1, FFTW_FORWARD, plannerFlags);
+  assert(columnPlan);
+
+  rowPlan = FftwTraits<T>::planManyDft(rowLength, localLength / rowLength,
+      work, 1, rowLength, work, 1, rowLength, FFTW_FORWARD, plannerFlags);
+  assert(rowPlan);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * W_N^(n2 * k1) for the local columns in their storage order, the
+ * exponent is reduced modulo N before the conversion to T
+ */
+template <typename T>
+void SixStepRuntime<T>::calculateTwiddles()
+{
+  long double step = -2.0L * M_PIl / totalVectorLength;
+  long length = localLength;
+
+  twiddles = (complex_t *) FftwTraits<T>::allocate(sizeof(complex_t) * localLength);
+  assert(twiddles);
+
+#pragma omp parallel for schedule(static) num_threads(FftComputation<T>::getThreadCount())
+  for (long i = 0; i < length; i++)
+  {
+    unsigned long k1 = i / columns;
+    unsigned long n2 = rank + nodecount * (i % columns);
+    unsigned long k  = (n2 * k1) % totalVectorLength;
+    twiddles[i] = FftwTraits<T>::cexp(I * (T) (step * k));
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void SixStepRuntime<T>::multiplyTwiddles()
+{
+  complex_t * work = getLocalData();
+  long length = localLength;
+
+#pragma omp parallel for schedule(static) num_threads(FftComputation<T>::getThreadCount()) if(length >= 16384)
+  for (long i = 0; i < length; i++)
+  {
+    work[i] *= twiddles[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void SixStepRuntime<T>::startRuntime()
+{
+  forward();
+  gatherResult();
+}
+
+//------------------------------------------------------------------------------
+/*
+ * One transform of the plan on new input
+ */
+template <typename T>
+void SixStepRuntime<T>::execute()
+{
+  loadInput();
+  startRuntime();
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void SixStepRuntime<T>::forward()
+{
+  FftwTraits<T>::execute(columnPlan);
+  multiplyTwiddles();
+
+  gaspi_printf("Transpose\n");
+  transpose->execute();
+  FftwTraits<T>::execute(rowPlan);
+
+  gaspi_printf("Main Computation finished\n");
+}
+
+//------------------------------------------------------------------------------
+/*
+ * The master receives the local rows at rank * localLength of its
+ * initial buffers and sorts them into natural order
+ */
+template <typename T>
+void SixStepRuntime<T>::gatherResult()
+{
+  unsigned long buffersize = localLength * sizeof(complex_t);
+
+  /* the initial buffers of the master are free once every rank is done */
+  gaspi_barrier(group.getGroup(), GASPI_BLOCK);
+
+  if (rank != master_rank)
+  {
+    rdma->writeBlockToMaster(rdma->getCalcBufferOffset1(),
+                             rdma->getInitialOffset1() + rank * buffersize,
+                             buffersize, gatherNotifyBase + rank);
+    rdma->waitOnQueues();
+    return;
+  }
+
+  complex_t * result = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+  memcpy(result, getLocalData(), buffersize);
+  rdma->waitOnNotifies( gatherNotifyBase + 1 , nodecount - 1 );
+
+  /* the rows of all ranks are k1 = 0 ... N1 - 1 in order */
+  complex_t * sorted = new complex_t[totalVectorLength];
+  for (unsigned long k1 = 0; k1 < columnLength; k1++)
+  {
+    for (unsigned long k2 = 0; k2 < rowLength; k2++)
+    {
+      sorted[k1 + columnLength * k2] = result[k1 * rowLength + k2];
+    }
+  }
+  memcpy(result, sorted, totalVectorLength * sizeof(complex_t));
+  delete[] sorted;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Local part of the output, see the class comment for the layout
+ */
+template <typename T>
+typename SixStepRuntime<T>::complex_t * SixStepRuntime<T>::getLocalData()
+{
+  return (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getCalcBufferOffset1());
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void SixStepRuntime<T>::validateFFT()
+{
+  complex_t * pResult = (complex_t *) ((char *) rdma->getRdmaPointer()
+      + rdma->getInitialOffset1());
+
+  fftw_complex * values = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * totalVectorLength);
+  fftw_complex * out = (fftw_complex *) fftw_malloc(
+      sizeof(fftw_complex) * totalVectorLength);
+  fftw_plan plan = fftw_plan_dft_1d(totalVectorLength, values, out,
+      FFTW_FORWARD, FFTW_ESTIMATE);
+  rdma->readInputVector(0, totalVectorLength, values);
+  fftw_execute(plan);
+
+  gaspi_printf("Result of 1d six-step FFT, %lu x %lu\n", columnLength, rowLength);
+  double diff = 0.0;
+  double max = 0.0;
+  for (unsigned long i = 0; i < totalVectorLength; i++) {
+    double tmp_diff_real = creal(out[i]) - creal(pResult[i]);
+    double tmp_diff_imag = cimag(out[i]) - cimag(pResult[i]);
+
+    diff = std::abs(tmp_diff_real) > std::abs(diff) ? tmp_diff_real : diff;
+    diff = std::abs(tmp_diff_imag) > std::abs(diff) ? tmp_diff_imag : diff;
+    max = std::abs(creal(out[i])) > std::abs(max) ? creal(out[i]) : max;
+    max = std::abs(cimag(out[i])) > std::abs(max) ? cimag(out[i]) : max;
+  }
+  std::cout << "Relativer Fehler " <<  (double) (std::abs(diff) / std::abs(max)) << "\n";
+  std::cout << "Abweichnung max. " << std::abs(diff) << "\n";
+  std::cout << "max factor " << std::abs(max) << "\n";
+
+  fftw_free(values);
+  fftw_free(out);
+  fftw_destroy_plan(plan);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+SixStepRuntime<T>::~SixStepRuntime()
+{
+  delete transpose;
+  FftwTraits<T>::destroyPlan(columnPlan);
+  FftwTraits<T>::destroyPlan(rowPlan);
+  FftwTraits<T>::release(twiddles);
+  delete rdma;
+}
+
+//------------------------------------------------------------------------------
+template class SixStepRuntime<float>;
+template class SixStepRuntime<double>;
+template class SixStepRuntime<long double>;
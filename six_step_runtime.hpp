@@ -0,0 +1,86 @@
+/*
+ * six_step_runtime.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef SIX_STEP_RUNTIME_HPP_
+#define SIX_STEP_RUNTIME_HPP_
+#include <vector>
+#include "utils.hpp"
+#include "fftw_traits.hpp"
+#include "rdma_manager.hpp"
+#include "transpose.hpp"
+
+typedef enum Engine_t {
+  engine_merge, engine_sixstep
+} engine_t;
+
+/*
+ * Columns per rank of the six-step transform of length elements, the
+ * most square split with columns * nodecount <= length / (columns *
+ * nodecount) and length / (columns * nodecount) a multiple of nodecount.
+ * Returns 0 if length doesn't fit nodecount.
+ */
+unsigned long sixStepColumns(unsigned long length, gaspi_rank_t nodecount);
+
+/*
+ * Distributed 1d transform of length N = N1 * N2 with complex values of
+ * precision T in one all-to-all. x[N2 * n1 + n2] is a N1 x N2 matrix,
+ * rank r holds the columns n2 = r + nodecount * j, 0 <= j < columns,
+ * which is the cyclic input distribution of the merge engine:
+ *   1. FFT of length N1 of the local columns
+ *   2. multiplication with W_N^(n2 * k1)
+ *   3. transpose, rank q receives the rows q * N1 / nodecount ... of all columns
+ *   4. FFT of length N2 of the local rows
+ * The output stays distributed, rank q holds X[k1 + N1 * k2] of its rows
+ * k1 at (k1 - q * N1 / nodecount) * N2 + k2, gatherResult() sorts it
+ * into natural order on the master.
+ */
+template <typename T>
+class SixStepRuntime {
+
+public:
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  SixStepRuntime(unsigned long vectorlength, gaspi_segment_id_t seg,
+                 const ProcessGroup & group,
+                 unsigned int plannerFlags = FFTW_ESTIMATE);
+  ~SixStepRuntime();
+
+  void loadInput();
+  void execute();
+  void startRuntime();
+  void forward();
+  void gatherResult();
+  complex_t * getLocalData();
+  void validateFFT();
+
+private:
+  RdmaManager<T> * rdma;
+  Transpose<T> * transpose;
+  typename FftwTraits<T>::plan_t columnPlan;
+  typename FftwTraits<T>::plan_t rowPlan;
+  complex_t * twiddles;
+  unsigned long totalVectorLength;
+  unsigned long columns;
+  unsigned long columnLength;
+  unsigned long rowLength;
+  unsigned long localLength;
+  gaspi_notification_id_t distributionNotify;
+  gaspi_notification_id_t gatherNotifyBase;
+  const ProcessGroup & group;
+  gaspi_rank_t rank;
+  gaspi_rank_t nodecount;
+  gaspi_rank_t master_rank;
+
+  void initialOffsets();
+  void initialTranspose(gaspi_notification_id_t notifyBase);
+  void createPlans(unsigned int plannerFlags);
+  void calculateTwiddles();
+  void multiplyTwiddles();
+
+};
+
+#endif /* SIX_STEP_RUNTIME_HPP_ */
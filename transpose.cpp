@@ -0,0 +1,217 @@
+/*
+ * transpose.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <assert.h>
+#include <string.h>
+#include "transpose.hpp"
+#include "fft_computation.hpp"
+
+//------------------------------------------------------------------------------
+unsigned long Box::volume() const
+{
+  return count[0] * count[1] * count[2];
+}
+
+//------------------------------------------------------------------------------
+unsigned long Box::stride(unsigned int axis) const
+{
+  unsigned long stride = 1;
+  for (int i = 2; i >= 0 && order[i] != axis; i--)
+  {
+    stride *= count[order[i]];
+  }
+  return stride;
+}
+
+//------------------------------------------------------------------------------
+bool Box::intersect(const Box & other, Box & region) const
+{
+  for (unsigned int axis = 0; axis < 3; axis++)
+  {
+    unsigned long begin = start[axis] > other.start[axis] ?
+        start[axis] : other.start[axis];
+    unsigned long end   = start[axis] + count[axis] < other.start[axis] + other.count[axis] ?
+        start[axis] + count[axis] : other.start[axis] + other.count[axis];
+    if (begin >= end)
+      return false;
+    region.start[axis] = begin;
+    region.count[axis] = end - begin;
+    region.order[axis] = order[axis];
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * inputs[r] and outputs[r] are the boxes of rank r before and after the
+ * redistribution. The block of a sender covers the output box of the
+ * receiver except along one axis, so the blocks of all senders tile the
+ * receive buffer without gaps.
+ */
+template <typename T>
+Transpose<T>::Transpose(RdmaManager<T> * manager,
+                        const std::vector<Box> & inputs,
+                        const std::vector<Box> & outputs,
+                        unsigned long recvoffset,
+                        gaspi_notification_id_t notifybase)
+{
+  gaspi_rank_t nodecount = manager->getGroup().getSize();
+
+  rdma        = manager;
+  rank        = rdma->getGroup().getRank();
+  input       = inputs[rank];
+  output      = outputs[rank];
+  recvOffset  = recvoffset;
+  notifyBase  = notifybase;
+  notifyRange = nodecount;
+  notifyCount = 0;
+
+  unsigned long packOffset = 0;
+
+  /* start with the next rank, so the ranks don't all write to rank 0 first */
+  for (gaspi_rank_t i = 1; i <= nodecount; i++)
+  {
+    gaspi_rank_t dest = (rank + i) % nodecount;
+    Block block;
+
+    if (!input.intersect(outputs[dest], block.region))
+      continue;
+
+    for (unsigned int a = 0; a < 3; a++)
+      block.region.order[a] = outputs[dest].order[a];
+    block.offset = packOffset;
+    packs.push_back(block);
+
+    typename RdmaManager<T>::TransferEntry entry;
+    entry.nodeid       = dest;
+    entry.localOffset  = rdma->getInitialOffset1() + packOffset * sizeof(complex_t);
+    entry.remoteOffset = recvOffset
+        + slotOffset(block.region, outputs[dest]) * sizeof(complex_t);
+    entry.size         = block.region.volume() * sizeof(complex_t);
+    entry.notifyId     = notifyBase + rank;
+    sends.push_back(entry);
+
+    packOffset += block.region.volume();
+  }
+
+  for (gaspi_rank_t src = 0; src < nodecount; src++)
+  {
+    Block block;
+
+    if (!inputs[src].intersect(output, block.region))
+      continue;
+
+    for (unsigned int a = 0; a < 3; a++)
+      block.region.order[a] = output.order[a];
+    block.offset = slotOffset(block.region, output);
+    unpacks.push_back(block);
+
+    if (src != rank)
+      notifyCount++;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long Transpose<T>::slotOffset(const Box & region, const Box & layout)
+{
+  unsigned long offset = 0;
+  for (unsigned int axis = 0; axis < 3; axis++)
+  {
+    if (region.count[axis] == layout.count[axis])
+      continue;
+
+    /* at most one axis may be cut */
+    assert(offset == 0);
+    offset = region.start[axis] - layout.start[axis];
+    for (unsigned int a = 0; a < 3; a++)
+    {
+      if (a != axis)
+        offset *= layout.count[a];
+    }
+  }
+  return offset;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Copies region from src, stored as srcLayout, to dst, stored as dstLayout,
+ * in the storage order of dst
+ */
+template <typename T>
+void Transpose<T>::copyRegion(const complex_t * src, const Box & srcLayout,
+                              complex_t * dst, const Box & dstLayout,
+                              const Box & region)
+{
+  const unsigned int * o = dstLayout.order;
+  unsigned long srcStride[3], dstStride[3], srcBase = 0, dstBase = 0;
+
+  for (unsigned int axis = 0; axis < 3; axis++)
+  {
+    srcStride[axis] = srcLayout.stride(axis);
+    dstStride[axis] = dstLayout.stride(axis);
+    srcBase += (region.start[axis] - srcLayout.start[axis]) * srcStride[axis];
+    dstBase += (region.start[axis] - dstLayout.start[axis]) * dstStride[axis];
+  }
+
+  long outer = region.count[o[0]];
+  unsigned long middle = region.count[o[1]];
+  unsigned long inner  = region.count[o[2]];
+  bool contiguous = (srcStride[o[2]] == 1) && (dstStride[o[2]] == 1);
+
+#pragma omp parallel for schedule(static) num_threads(FftComputation<T>::getThreadCount()) \
+    if(region.volume() >= 16384)
+  for (long i = 0; i < outer; i++)
+  {
+    for (unsigned long j = 0; j < middle; j++)
+    {
+      const complex_t * s = src + srcBase + i * srcStride[o[0]] + j * srcStride[o[1]];
+      complex_t * d = dst + dstBase + i * dstStride[o[0]] + j * dstStride[o[1]];
+
+      if (contiguous)
+      {
+        memcpy(d, s, inner * sizeof(complex_t));
+        continue;
+      }
+      for (unsigned long k = 0; k < inner; k++)
+      {
+        d[k * dstStride[o[2]]] = s[k * srcStride[o[2]]];
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void Transpose<T>::execute()
+{
+  char * base = (char *) rdma->getRdmaPointer();
+  complex_t * work = (complex_t *) (base + rdma->getCalcBufferOffset1());
+  complex_t * pack = (complex_t *) (base + rdma->getInitialOffset1());
+  complex_t * recv = (complex_t *) (base + recvOffset);
+
+  for (unsigned long i = 0; i < packs.size(); i++)
+  {
+    copyRegion(work, input, pack + packs[i].offset, packs[i].region,
+               packs[i].region);
+  }
+
+  rdma->writeTransfers(sends);
+  rdma->waitOnNotifyRange( notifyBase , notifyRange , notifyCount );
+  rdma->waitOnQueues();
+
+  for (unsigned long i = 0; i < unpacks.size(); i++)
+  {
+    copyRegion(recv + unpacks[i].offset, unpacks[i].region, work, output,
+               unpacks[i].region);
+  }
+}
+
+//------------------------------------------------------------------------------
+template class Transpose<float>;
+template class Transpose<double>;
+template class Transpose<long double>;
@@ -0,0 +1,82 @@
+/*
+ * transpose.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef TRANSPOSE_HPP_
+#define TRANSPOSE_HPP_
+#include <vector>
+#include "utils.hpp"
+#include "fftw_traits.hpp"
+#include "rdma_manager.hpp"
+
+/*
+ * Part of a 3d array held by one rank: the index range start..start+count
+ * along every axis (0 = x, 1 = y, 2 = z), stored row major with the axes
+ * in the given order, order[2] is the contiguous one.
+ */
+struct Box
+{
+  unsigned long start[3];
+  unsigned long count[3];
+  unsigned int  order[3];
+
+  unsigned long volume() const;
+  /* distance of two neighbours along axis in the local storage */
+  unsigned long stride(unsigned int axis) const;
+  bool          intersect(const Box & other, Box & region) const;
+};
+
+/*
+ * Redistribution of a distributed 3d array between two decompositions,
+ * the all-to-all of a multi-dimensional transform. Every rank sends the
+ * intersection of its input box with the output box of every other rank.
+ * The blocks are packed in the storage order of the receiver, written
+ * into its receive buffer and unpacked into its calc buffer.
+ */
+template <typename T>
+class Transpose {
+
+public:
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  Transpose(RdmaManager<T> * manager,
+            const std::vector<Box> & inputs,
+            const std::vector<Box> & outputs,
+            unsigned long recvOffset,
+            gaspi_notification_id_t notifyBase);
+
+  void execute();
+
+  static void copyRegion(const complex_t * src, const Box & srcLayout,
+                         complex_t * dst, const Box & dstLayout,
+                         const Box & region);
+
+private:
+  struct Block
+  {
+    Box           region;
+    unsigned long offset;
+  };
+
+  RdmaManager<T> * rdma;
+  gaspi_rank_t rank;
+  Box input;
+  Box output;
+  gaspi_notification_id_t notifyBase;
+  gaspi_notification_id_t notifyRange;
+  unsigned int notifyCount;
+  /* packed blocks in the send buffer, same order as sends */
+  std::vector<Block> packs;
+  std::vector<typename RdmaManager<T>::TransferEntry> sends;
+  /* received blocks in the receive buffer */
+  std::vector<Block> unpacks;
+  unsigned long recvOffset;
+
+  static unsigned long slotOffset(const Box & region, const Box & layout);
+
+};
+
+#endif /* TRANSPOSE_HPP_ */
@@ -0,0 +1,181 @@
+/*
+ * twiddle_cache.cpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+#include <iostream>
+#include <math.h>
+#include <assert.h>
+#include "twiddle_cache.hpp"
+#include "fft_computation.hpp"
+
+template <typename T>
+TwiddleCache<T> * TwiddleCache<T>::singleton = NULL;
+
+template <typename T>
+TwiddleCache<T> * TwiddleCache<T>::getInstance()
+{
+  if (singleton == NULL)
+  {
+    singleton = new TwiddleCache<T>();
+    assert(singleton);
+  }
+
+  return singleton;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void TwiddleCache<T>::destroyInstance()
+{
+  if (singleton != NULL)
+  {
+    delete singleton;
+    singleton = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+TwiddleCache<T>::TwiddleCache()
+: scratch( NULL ), scratchLength( 0 ), mode( twiddles_cached )
+{
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+TwiddleCache<T>::~TwiddleCache()
+{
+  clear();
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void TwiddleCache<T>::setMode(twiddle_mode_t newMode)
+{
+  if (newMode != mode)
+  {
+    clear();
+    mode = newMode;
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+twiddle_mode_t TwiddleCache<T>::getMode()
+{
+  return mode;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void TwiddleCache<T>::clear()
+{
+  for (unsigned long i = 0; i < tables.size(); i++)
+  {
+    FftwTraits<T>::release(tables[i].table);
+  }
+  tables.clear();
+
+  if (scratch != NULL)
+  {
+    FftwTraits<T>::release(scratch);
+    scratch = NULL;
+  }
+  scratchLength = 0;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+const typename TwiddleCache<T>::complex_t *
+TwiddleCache<T>::getTable(unsigned long kmin,
+                          unsigned long mergelength,
+                          unsigned long length)
+{
+  if (mode == twiddles_on_the_fly)
+  {
+    if (scratchLength < length)
+    {
+      if (scratch != NULL)
+        FftwTraits<T>::release(scratch);
+      scratch = (complex_t *) FftwTraits<T>::allocate(sizeof(complex_t) * length);
+      assert(scratch);
+      scratchLength = length;
+    }
+    fillTable(scratch, kmin, mergelength, length);
+    return scratch;
+  }
+
+  for (unsigned long i = 0; i < tables.size(); i++)
+  {
+    if ((tables[i].kmin == kmin) && (tables[i].mergelength == mergelength)
+        && (tables[i].length == length))
+    {
+      return tables[i].table;
+    }
+  }
+
+  TableEntry entry;
+  entry.kmin        = kmin;
+  entry.mergelength = mergelength;
+  entry.length      = length;
+  entry.table       = (complex_t *) FftwTraits<T>::allocate(sizeof(complex_t) * length);
+  assert(entry.table);
+
+  fillTable(entry.table, kmin, mergelength, length);
+  tables.push_back(entry);
+
+  return entry.table;
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+unsigned long TwiddleCache<T>::getMemoryFootprint()
+{
+  unsigned long bytes = scratchLength * sizeof(complex_t);
+  for (unsigned long i = 0; i < tables.size(); i++)
+  {
+    bytes += tables[i].length * sizeof(complex_t);
+  }
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Rotation recurrence t(k+1) = t(k) * exp(-2 pi I / mergelength), restarted
+ * from an exactly evaluated twiddle every resyncInterval entries so the
+ * rounding error can't accumulate over the table.
+ */
+template <typename T>
+void TwiddleCache<T>::fillTable(complex_t * table,
+                                unsigned long kmin,
+                                unsigned long mergelength,
+                                unsigned long length)
+{
+  long double step = -2.0L * M_PIl / mergelength;
+  complex_t rotation = FftwTraits<T>::cexp(I * (T) step);
+  long blocks = (length + resyncInterval - 1) / resyncInterval;
+
+  /* the blocks are independent of each other */
+#pragma omp parallel for schedule(static) num_threads(FftComputation<T>::getThreadCount()) \
+    if(length >= parallelThreshold)
+  for (long b = 0; b < blocks; b++)
+  {
+    unsigned long i   = b * resyncInterval;
+    unsigned long end = i + resyncInterval < length ? i + resyncInterval : length;
+    unsigned long k   = (kmin + i) % mergelength;
+    complex_t     t   = FftwTraits<T>::cexp(I * (T) (step * k));
+
+    for (unsigned long j = i; j < end; j++)
+    {
+      table[j] = t;
+      t *= rotation;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template class TwiddleCache<float>;
+template class TwiddleCache<double>;
+template class TwiddleCache<long double>;
@@ -0,0 +1,76 @@
+/*
+ * twiddle_cache.hpp
+ *
+ *  Created on: 17.10.2026
+ *      Author: Christian Herold
+ */
+
+#ifndef TWIDDLE_CACHE_HPP_
+#define TWIDDLE_CACHE_HPP_
+#include <vector>
+#include "fftw_traits.hpp"
+
+typedef enum Twiddle_Mode_t {
+  twiddles_cached, twiddles_on_the_fly
+} twiddle_mode_t;
+
+/*
+ * Process wide store of the twiddle tables
+ *   table[i] = exp(-2 pi I (kmin + i) / mergelength) , 0 <= i < length
+ * A table only depends on (kmin, mergelength, length), which are fixed per
+ * rank and level for a given vector length, so in cached mode every table
+ * is built once and reused by all following transforms.
+ * In on-the-fly mode only one scratch table is held and rebuilt per request,
+ * it is only valid until the next request. The merge stages keep their
+ * table across chunks, so every FftComputation fills its own instead.
+ * There is one cache per precision T.
+ */
+template <typename T>
+class TwiddleCache {
+
+public:
+  typedef typename FftwTraits<T>::complex_t complex_t;
+
+  static TwiddleCache* getInstance( void );
+  void                 destroyInstance();
+
+  void                 setMode(twiddle_mode_t mode);
+  twiddle_mode_t       getMode();
+
+  const complex_t *    getTable(unsigned long kmin,
+                                unsigned long mergelength,
+                                unsigned long length);
+
+  unsigned long        getMemoryFootprint();
+  void                 clear();
+
+  static void          fillTable(complex_t * table,
+                                 unsigned long kmin,
+                                 unsigned long mergelength,
+                                 unsigned long length);
+
+private:
+  struct TableEntry
+  {
+    unsigned long   kmin;
+    unsigned long   mergelength;
+    unsigned long   length;
+    complex_t *     table;
+  };
+
+  /* entries between two exactly evaluated twiddles of the recurrence */
+  static const unsigned long resyncInterval = 32;
+  /* tables shorter than this are filled by a single thread */
+  static const unsigned long parallelThreshold = 16384;
+
+  std::vector<TableEntry> tables;
+  complex_t *             scratch;
+  unsigned long           scratchLength;
+  twiddle_mode_t          mode;
+  static TwiddleCache*    singleton;
+
+  TwiddleCache();
+  ~TwiddleCache();
+
+};
+#endif /* TWIDDLE_CACHE_HPP_ */
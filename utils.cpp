@@ -16,10 +16,9 @@ int
 calculate_comm_partners( int*  parent,
                          int** children,
                          int   me,
-                         int   root )
+                         int   root,
+                         gaspi_rank_t size )
 {
-  gaspi_rank_t size;
-  gaspi_proc_num( &size );
   unsigned int size_pot = npot( size );
 
   unsigned int d;
@@ -74,6 +73,28 @@ calculate_comm_partners( int*  parent,
 
   return number_of_children;
 }
+/*
+ * Number of ranks in the subtree of me of the binomial tree of
+ * calculate_comm_partners, me included. The subtree of a child c of me
+ * are the ranks c ... c + span - 1 relative to root.
+ */
+unsigned int
+scatter_span( int me,
+              int root,
+              gaspi_rank_t size )
+{
+  me -= root;
+  if( me < 0 )
+    me += size;
+
+  if( me == 0 )
+    return size;
+
+  int span = me & -me;
+  if( me + span > size )
+    span = size - me;
+  return span;
+}
 gaspi_rank_t
 gaspi_bcast_binominal(  gaspi_segment_id_t  seg_id,
                         unsigned long       offset,
@@ -86,7 +107,7 @@ gaspi_bcast_binominal(  gaspi_segment_id_t  seg_id,
   int*                    children = NULL;
 
   gaspi_notification_id_t first_id;
-  gaspi_return_t          retval;
+  gaspi_return_t          retval = GASPI_SUCCESS;
   gaspi_rank_t            rank;
   gaspi_timeout_t         timeout = 2000;
   gaspi_notification_id_t notify_id = 0;
@@ -96,7 +117,7 @@ gaspi_bcast_binominal(  gaspi_segment_id_t  seg_id,
   gaspi_proc_rank( &rank );
   gaspi_proc_num( &rankcount );
 
-  children_count = calculate_comm_partners( &parent , &children , rank , root );
+  children_count = calculate_comm_partners( &parent , &children , rank , root , rankcount );
 
   /*
    * parents + children wait for upper parents data
@@ -137,3 +158,36 @@ gaspi_bcast_binominal(  gaspi_segment_id_t  seg_id,
   free( children );
   return retval;
 }
+/*
+ * values[r] is the value of group rank r afterwards. Sums of
+ * gaspi_allreduce in which every rank only sets its own entry, in blocks
+ * of the maximum element count.
+ */
+void
+gaspi_allgather_ulong( unsigned long   value,
+                       unsigned long*  values,
+                       gaspi_rank_t    rank,
+                       gaspi_rank_t    size,
+                       gaspi_group_t   group )
+{
+  gaspi_number_t elem_max = 1;
+  gaspi_allreduce_elem_max( &elem_max );
+
+  unsigned long* send = (unsigned long *) malloc( sizeof( *send ) * elem_max );
+
+  for ( unsigned int first = 0; first < size; first += elem_max )
+  {
+    gaspi_number_t count = size - first < elem_max ? size - first : elem_max;
+
+    for ( unsigned int i = 0; i < count; i++ )
+      send[ i ] = ( first + i == rank ) ? value : 0;
+
+    if( gaspi_allreduce( send, values + first, count, GASPI_OP_SUM,
+                         GASPI_TYPE_ULONG, group, GASPI_BLOCK ) != GASPI_SUCCESS )
+    {
+      std::cerr << "gaspi_allreduce failed in gaspi_allgather_ulong()\n";
+      exit( 2 );
+    }
+  }
+  free( send );
+}
@@ -29,10 +29,29 @@ typedef enum Send_t {
   calc_buffer1, calc_buffer2
 } send_t;
 
+int
+calculate_comm_partners( int*  parent,
+                         int** children,
+                         int   me,
+                         int   root,
+                         gaspi_rank_t size );
+
+unsigned int
+scatter_span( int me,
+              int root,
+              gaspi_rank_t size );
+
 gaspi_rank_t
 gaspi_bcast_binominal(  gaspi_segment_id_t  seg_id,
                         unsigned long       offset,
                         unsigned long       bytesize,
                         gaspi_rank_t        root );
 
+void
+gaspi_allgather_ulong( unsigned long   value,
+                       unsigned long*  values,
+                       gaspi_rank_t    rank,
+                       gaspi_rank_t    size,
+                       gaspi_group_t   group );
+
 #endif /* UTILS_HPP_ */
@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# Correctness runs on 4 ranks, each has to report a relative error below
+# its limit. LAUNCH starts the binary on 4 ranks, e.g.
+#   LAUNCH="./gpi_run.sh -n 4" ./validate.sh ./bin/main
+# The threaded runs need a build with -fopenmp.
+#
+BIN=${1:-./bin/main}
+LAUNCH=${LAUNCH:-"./gpi_run.sh -n 4"}
+failed=0
+
+check()
+{
+  limit=$1
+  shift
+  error=$($LAUNCH $BIN "$@" 2>&1 | grep "Relativer Fehler" | awk '{ print $NF }' \
+          | sort -g | tail -1)
+  if [ -z "$error" ] || ! awk "BEGIN { exit !($error < $limit) }"; then
+    echo "FAILED: $* ($error)"
+    failed=$((failed + 1))
+  else
+    echo "ok    : $* ($error)"
+  fi
+}
+
+check 1e-9 65536 U v
+check 1e-9 65536 U v radix=4 chunks=3
+check 1e-9 65536 U v input=real transform=roundtrip
+# merge blocks of 16385 elements, not divisible by the thread count
+check 1e-9 131080 U v threads=8
+check 1e-9 65536 U v threads=3 radix=4
+# blocks of 4 elements of a large batch, split over the vectors
+check 1e-9 32 U v batch=4096 threads=8
+check 1e-9 65536 U v batch=3 threads=5 input=real transform=roundtrip
+# two transforms in flight through start/test
+check 1e-9 65536 U v overlap=2 cycles=2 chunks=3
+check 1e-9 65536 U v overlap=3 input=real output=natural
+
+# shm=yes: with r ranks per host the first log2(r) radix-2 stages merge
+# from the calc buffers of the peers, r is taken from the output of rank 0
+output=$($LAUNCH $BIN 65536 U v radix=2 shm=yes 2>&1)
+peers=$(echo "$output" | grep "peers on the same host" | head -1 | awk '{ print $NF }')
+stages=""
+for s in 1 2; do
+  stages="$stages$(echo "$output" | grep "merge stage  $s " | head -1 | awk -F': ' '{ print $NF }');"
+done
+case "$peers" in
+  1) expected="peer calc buffers;receive buffers;" ;;
+  3) expected="peer calc buffers;peer calc buffers;" ;;
+  *) expected="receive buffers;receive buffers;" ;;
+esac
+error=$(echo "$output" | grep "Relativer Fehler" | awk '{ print $NF }' | sort -g | tail -1)
+if [ "$stages" != "$expected" ] || [ -z "$error" ] \
+   || ! awk "BEGIN { exit !($error < 1e-9) }"; then
+  echo "FAILED: shm stages with $peers peers: $stages ($error)"
+  failed=$((failed + 1))
+else
+  echo "ok    : shm stages with $peers peers: $stages ($error)"
+fi
+
+exit $failed